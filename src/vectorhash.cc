@@ -7,6 +7,11 @@
 //  Distributed under the "zlib license". See the accompanying LICENSE file.
 //-------------------------------------------------------------------------------
 
+// make sure that files larger than 2 GiB can be handled on 32-bit platforms
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS 64
+#endif
+
 #include <iostream>
 #include <iomanip>
 #include <cstdint>
@@ -15,8 +20,15 @@
 #include <sstream>
 #include <cstdlib>
 #include <cstring>
+#include <cerrno>
 #include <regex>
 #include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <system_error>
+#include <chrono>
 
 #if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
 #include <unistd.h>
@@ -26,10 +38,23 @@
 
 #if _POSIX_MAPPED_FILES > 0
 #include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 
 #include <fcntl.h>
 
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+#ifdef __NR_io_uring_setup
+#define VH_HAVE_URING 1
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#endif
+#endif
+#endif
+
 // O_BINARY is not defined on systems where there
 // is no distinction between binary and text I/O.
 #ifndef O_BINARY
@@ -46,6 +71,23 @@
 
 static string SIMDname[] = { "Scalar", "SSE2", "AVX2", "AVX512" };
 
+// the default size of the buffers used for reading stdin
+static const size_t vh_bufsize_default = size_t(1) << 20;
+// the default size of the windows used for reading large files
+static const size_t vh_window_default = size_t(64) << 20;
+// the default amount of data the kernel is asked to read ahead
+static const size_t vh_readahead_default = size_t(16) << 20;
+// files up to this size are read completely when they are mapped
+static const size_t vh_populate_max = size_t(4) << 20;
+// the default number of reads that are kept in flight with --io uring
+static const size_t vh_iodepth_default = 8;
+// the alignment of the buffers and the granularity of the reads with --direct
+static const size_t vh_direct_align = 4096;
+// buffers of at least this size are backed by huge pages when possible
+static const size_t vh_hugepage = size_t(2) << 20;
+// the minimum time (in seconds) between two saves of the checkpoint file
+static const double vh_checkpoint_interval = 10.;
+
 struct vh_params {
 	string cmd;
 	string name;
@@ -58,12 +100,33 @@ struct vh_params {
 	bool lgQuiet;
 	bool lgStatusOnly;
 	bool lgStrict;
+	bool lgTree;
 	bool lgWarnSyntax;
 	bool lgVerbose;
 	bool lgZero;
 	is_type SIMDversion;
 	int returncode;
 	uint32_t seed;
+	size_t nthreads;
+	size_t njobs;
+	size_t bufsize;
+	size_t window;
+	size_t readahead;
+	bool lgUring;
+	size_t iodepth;
+	bool lgDirect;
+	bool lgDropCache;
+	bool lgHugePages;
+	vector<size_t> widths; // all widths when more than one was requested with -l
+	vector<uint32_t> seeds; // all seeds when more than one was requested with --seed
+	string checkpoint;      // the state is saved periodically to this file
+	bool lgResume;
+	bool lgIncremental;
+	size_t indexchunk;      // the chunk size of the index written with --index, 0 means no index
+	bool lgVerifyRange;
+	uint64_t range_off;     // the range given with --verify-range
+	uint64_t range_len;
+	bool lgDiffIndex;
 	size_t vh_hash_width;
 	size_t vh_virtreg_width;
 	size_t vh_nstate;
@@ -94,18 +157,29 @@ struct vh_params {
 		vh_nhash = hw/32;
 		// update the name as well...
 		ostringstream oss;
-		oss << "VH" << vh_hash_width;
+		oss << ( lgTree ? "VHT" : "VH" ) << vh_hash_width;
 		name = oss.str();
 		return true;
 	}
 	vh_params() : lgBSDstyle(false), lgCheckMode(false), lgIgnoreMissing(false), lgBinarySet(false),
 				  lgTextSet(false), lgBinary(false), lgQuiet(false), lgStatusOnly(false), lgStrict(false),
-				  lgWarnSyntax(false), lgVerbose(false), lgZero(false), SIMDversion(IS_INVALID),
-				  returncode(0), seed(0xfd4c799d)
+				  lgTree(false), lgWarnSyntax(false), lgVerbose(false), lgZero(false), SIMDversion(IS_INVALID),
+				  returncode(0), seed(0xfd4c799d), nthreads(1), njobs(1),
+				  bufsize(vh_bufsize_default), window(vh_window_default),
+				  readahead(vh_readahead_default), lgUring(false), iodepth(vh_iodepth_default),
+				  lgDirect(false), lgDropCache(false), lgHugePages(true), lgResume(false),
+				  lgIncremental(false), indexchunk(0), lgVerifyRange(false), range_off(0), range_len(0),
+				  lgDiffIndex(false)
 	{
 		(void)set_hash_width(32);
 	}
 	char sentinel() const { return lgBinary ? '*' : ' '; }
+	// are several checksums computed for each file?
+	bool multi() const { return widths.size() > 1 || seeds.size() > 1; }
+	vector<size_t> all_widths() const { return widths.empty() ? vector<size_t>(1, vh_hash_width) : widths; }
+	vector<uint32_t> all_seeds() const { return seeds.empty() ? vector<uint32_t>(1, seed) : seeds; }
+	// a value of 0 for the number of threads or jobs means use all cores
+	static size_t ncores(size_t n) { return ( n == 0 ) ? max(thread::hardware_concurrency(), 1u) : n; }
 	string option() const { return lgBinary ? "rb" : "r"; }
 	void SetSIMDVersion()
 	{
@@ -161,6 +235,260 @@ inline void posix_memalign_free(void *p)
 }
 #endif
 
+//-----------------------------------------------------------------------------
+// An aligned buffer for staging data before it is checksummed. Large buffers are
+// backed by huge pages when possible, since with 4 KiB pages every few blocks
+// would need a new TLB entry. Explicitly reserved huge pages (MAP_HUGETLB) are
+// tried first, then transparent huge pages, and finally normal pages.
+
+class vh_buffer
+{
+	char* p;
+	size_t msize;  // the size of the mapping, 0 if p was allocated with posix_memalign
+	bool lgHuge;
+
+	vh_buffer(const vh_buffer&) = delete;
+	vh_buffer& operator=(const vh_buffer&) = delete;
+public:
+	vh_buffer() : p(nullptr), msize(0), lgHuge(false) {}
+	~vh_buffer() { release(); }
+	// allocate n bytes aligned on an align byte boundary, align must not exceed the page size
+	bool alloc(size_t n, size_t align, bool lgHugePages)
+	{
+		release();
+#if _POSIX_MAPPED_FILES > 0 && defined(MAP_ANONYMOUS)
+		if( lgHugePages && n >= vh_hugepage )
+		{
+			size_t sz = (n + vh_hugepage - 1)/vh_hugepage*vh_hugepage;
+			void* m = MAP_FAILED;
+#ifdef MAP_HUGETLB
+			m = mmap( NULL, sz, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0 );
+			if( m != MAP_FAILED )
+			{
+				p = (char*)m;
+				msize = sz;
+				lgHuge = true;
+				return true;
+			}
+#endif
+#ifdef MADV_HUGEPAGE
+			// transparent huge pages can only be used for a region that is aligned on a huge page
+			m = mmap( NULL, sz + vh_hugepage, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0 );
+			if( m != MAP_FAILED )
+			{
+				char* a = (char*)( (uintptr_t(m) + vh_hugepage - 1)/vh_hugepage*vh_hugepage );
+				size_t head = size_t(a - (char*)m);
+				if( head > 0 )
+					munmap( m, head );
+				if( vh_hugepage - head > 0 )
+					munmap( a + sz, vh_hugepage - head );
+				p = a;
+				msize = sz;
+				lgHuge = ( madvise( p, sz, MADV_HUGEPAGE ) == 0 );
+				return true;
+			}
+#endif
+		}
+#else
+		(void)lgHugePages;
+#endif
+		void* b;
+		if( posix_memalign( &b, align, n ) != 0 )
+			return false;
+		p = (char*)b;
+		return true;
+	}
+	void release()
+	{
+		if( p != nullptr )
+		{
+#if _POSIX_MAPPED_FILES > 0 && defined(MAP_ANONYMOUS)
+			if( msize > 0 )
+				munmap( p, msize );
+			else
+#endif
+				posix_memalign_free( p );
+		}
+		p = nullptr;
+		msize = 0;
+		lgHuge = false;
+	}
+	char* data() const { return p; }
+	// were huge pages requested successfully?
+	bool huge() const { return lgHuge; }
+};
+
+//-----------------------------------------------------------------------------
+// Asynchronous reader for stdin and pipes. A separate thread fills a ring of
+// large aligned buffers while the caller checksums the buffers filled earlier,
+// so that the I/O and the computation overlap. A file descriptor can also be
+// read directly from the disk (bypassing the page cache) with O_DIRECT.
+
+// the number of buffers in the ring
+static const size_t vh_nbuf = 4;
+
+class vh_reader
+{
+	FILE* io;
+	int fd;        // when fd >= 0 it is read with read() instead of fread() from io
+	uint64_t off;  // the offset in fd of the next read
+	bool lgDirect; // is fd opened with O_DIRECT?
+	bool lgDrop;   // drop data that was read through the page cache?
+	bool lgError;
+	size_t bufsize;
+	size_t nbuf;
+	vh_buffer ring; // the nbuf buffers are stored consecutively
+	vector<size_t> len;
+	size_t head;   // next buffer that will be filled by the reader
+	size_t tail;   // next buffer that will be handed out by get()
+	size_t nfull;  // number of filled buffers that were not yet released
+	bool lgDone;
+	mutex mtx;
+	condition_variable cv;
+	thread reader;
+
+	void fill(size_t i)
+	{
+		if( fd < 0 )
+		{
+			len[i] = fread( buffer(i), 1, bufsize, io );
+			return;
+		}
+#if _POSIX_MAPPED_FILES > 0
+		len[i] = 0;
+		while( len[i] < bufsize )
+		{
+			ssize_t r = read( fd, buffer(i)+len[i], bufsize-len[i] );
+			if( r < 0 && errno == EINTR )
+				continue;
+#ifdef O_DIRECT
+			// after a short read the offset is no longer aligned, e.g. at the end of a file that
+			// is not a multiple of the block size, then continue reading through the page cache
+			if( r < 0 && errno == EINVAL && lgDirect )
+			{
+				lgDirect = false;
+				if( fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) & ~O_DIRECT ) == 0 )
+					continue;
+			}
+#endif
+			if( r < 0 )
+				lgError = true;
+			if( r <= 0 )
+				break;
+			len[i] += size_t(r);
+		}
+#ifdef POSIX_FADV_DONTNEED
+		// data that was read through the page cache will not be needed again, but it may
+		// have been cached already for another process, so this is only done on request
+		if( !lgDirect && lgDrop )
+			(void)posix_fadvise( fd, off_t(off), off_t(len[i]), POSIX_FADV_DONTNEED );
+#endif
+		off += len[i];
+#endif
+	}
+	void ReadLoop()
+	{
+		while( true )
+		{
+			unique_lock<mutex> lock(mtx);
+			cv.wait( lock, [&]() { return nfull < nbuf || lgDone; } );
+			if( lgDone )
+				return;
+			size_t i = head;
+			lock.unlock();
+			fill(i);
+			lock.lock();
+			head = (head+1)%nbuf;
+			++nfull;
+			// a short read means end of file or a read error
+			if( len[i] < bufsize )
+				lgDone = true;
+			cv.notify_all();
+			if( lgDone )
+				return;
+		}
+	}
+	vh_reader(const vh_reader&) = delete;
+	vh_reader& operator=(const vh_reader&) = delete;
+	char* buffer(size_t i) const { return ring.data() + i*bufsize; }
+	void start(size_t align, bool lgHugePages)
+	{
+		if( !ring.alloc( nbuf*bufsize, align, lgHugePages ) )
+			return;
+		try
+		{
+			reader = thread( &vh_reader::ReadLoop, this );
+		}
+		catch( const system_error& )
+		{
+			// we could not start a new thread, so get() will read synchronously
+		}
+	}
+public:
+	vh_reader(FILE* f, size_t bs, size_t nb, bool lgHugePages) : io(f), fd(-1), off(0), lgDirect(false),
+		lgDrop(false), lgError(false), bufsize(bs), nbuf(nb), len(nb, 0), head(0), tail(0), nfull(0), lgDone(false)
+	{
+		start( vh_hwreg_width/8, lgHugePages );
+	}
+	// read fd from its current offset (which need not be 0 for standard input) up to the end, bypassing
+	// the page cache if possible, bs must be a multiple of vh_direct_align for O_DIRECT to be used
+	vh_reader(int f, size_t bs, size_t nb, bool lgHugePages, bool lgDropCache) : io(nullptr), fd(f), off(0),
+		lgDirect(false), lgDrop(lgDropCache), lgError(false), bufsize(bs), nbuf(nb), len(nb, 0), head(0), tail(0), nfull(0), lgDone(false)
+	{
+#if _POSIX_MAPPED_FILES > 0
+		// this fails for pipes, which cannot be dropped from the page cache anyway
+		off_t pos = lseek( fd, 0, SEEK_CUR );
+		if( pos > 0 )
+			off = uint64_t(pos);
+#endif
+#ifdef O_DIRECT
+		if( bufsize%vh_direct_align == 0 )
+			lgDirect = ( fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_DIRECT ) == 0 );
+#endif
+		start( vh_direct_align, lgHugePages );
+	}
+	~vh_reader()
+	{
+		if( reader.joinable() )
+		{
+			{
+				lock_guard<mutex> lock(mtx);
+				lgDone = true;
+				cv.notify_all();
+			}
+			reader.join();
+		}
+	}
+	// did all reads use O_DIRECT? only valid after the last buffer was handed out
+	bool direct() const { return lgDirect; }
+	// did a read error occur? only valid after the last buffer was handed out
+	bool error() const { return lgError; }
+	bool ok() const { return ring.data() != nullptr; }
+	bool huge() const { return ring.huge(); }
+	// wait for the next buffer, n < bufsize indicates that this is the last one
+	const void* get(size_t& n)
+	{
+		if( !reader.joinable() )
+			fill(tail);
+		else
+		{
+			unique_lock<mutex> lock(mtx);
+			cv.wait( lock, [&]() { return nfull > 0; } );
+		}
+		n = len[tail];
+		return buffer(tail);
+	}
+	// hand the buffer obtained with get() back to the reader
+	void release()
+	{
+		lock_guard<mutex> lock(mtx);
+		if( reader.joinable() )
+			--nfull;
+		tail = (tail+1)%nbuf;
+		cv.notify_all();
+	}
+};
+
 struct pstr
 {
 	string s;
@@ -246,193 +574,1490 @@ inline string escfn(const string& s)
 	return oss.str();
 }
 
-static string VHstream(const vh_params& vhp, FILE* io)
+// accumulates the checksum of a stream that arrives in pieces of arbitrary size
+class vh_digest
 {
-	if( fseek( io, 0, SEEK_END ) != 0 )
-		return string();
-	long fsize = ftell(io);
-	if( fsize < 0 )
-		return string();
-	vector<uint32_t> state(vhp.vh_nstate);
-#if _POSIX_MAPPED_FILES > 0
-	int fd = fileno(io);
-	char* map = ( fsize > 0 ) ? (char*)mmap( NULL, fsize, PROT_READ, MAP_SHARED, fd, 0 ) : nullptr;
-	if( fsize > 0 && map == MAP_FAILED )
-		return string();
-	VectorHash( map, fsize, vhp.seed, state.data(), vhp.SIMDversion, vhp.vh_hash_width );
-	munmap(map, fsize);
-#else
-	if( fseek( io, 0, SEEK_SET ) != 0 )
-		return string();
-	void* map = NULL;
-	if( fsize > 0 )
+	const vh_params& vhp;
+	vh_state st;
+	vector<uint32_t> leaves;
+	uint64_t len;
+public:
+	explicit vh_digest(const vh_params& p) : vhp(p), len(0)
 	{
-		if( posix_memalign( &map, vh_hwreg_width/8, fsize ) != 0 )
-			return string();
-		if( fread( map, fsize, 1, io ) != 1 )
-			return string();
+		VectorHashInit( &st, vhp.seed, vhp.SIMDversion, vhp.vh_hash_width );
 	}
-	VectorHash( map, fsize, vhp.seed, state.data(), vhp.SIMDversion, vhp.vh_hash_width );
-	if( map != NULL )
-		posix_memalign_free( map );
-#endif
+	void update(const void* buf, size_t n)
+	{
+		len += n;
+		if( !vhp.lgTree )
+		{
+			VectorHashUpdate( &st, buf, n );
+			return;
+		}
+		// each chunk of the tree is checksummed separately
+		const uint8_t* p = (const uint8_t*)buf;
+		while( n > 0 )
+		{
+			size_t k = min(n, VH_TREE_CHUNKSIZE - size_t(st.len));
+			VectorHashUpdate( &st, p, k );
+			p += k;
+			n -= k;
+			if( st.len == VH_TREE_CHUNKSIZE )
+			{
+				leaves.resize( leaves.size() + vhp.vh_nhash );
+				VectorHashFinal( &st, &leaves[leaves.size()-vhp.vh_nhash] );
+				VectorHashInit( &st, vhp.seed, vhp.SIMDversion, vhp.vh_hash_width );
+			}
+		}
+	}
+	string final()
+	{
+		vector<uint32_t> state(vhp.vh_nstate);
+		if( vhp.lgTree )
+		{
+			if( st.len > 0 || leaves.empty() )
+			{
+				leaves.resize( leaves.size() + vhp.vh_nhash );
+				VectorHashFinal( &st, &leaves[leaves.size()-vhp.vh_nhash] );
+			}
+			VectorHashTreeRoot( leaves.data(), leaves.size()/vhp.vh_nhash, len, vhp.seed, state.data(),
+								vhp.SIMDversion, vhp.vh_hash_width, 0 );
+		}
+		else
+			VectorHashFinal( &st, state.data() );
 
-	ostringstream hash;
-	for( size_t i=0; i < vhp.vh_nhash; ++i )
-		hash << hex << setfill('0') << setw(8) << state[i];
+		ostringstream hash;
+		for( size_t i=0; i < vhp.vh_nhash; ++i )
+			hash << hex << setfill('0') << setw(8) << state[i];
 
-	return hash.str();
-}
+		return hash.str();
+	}
+};
 
-static string VHstdin(const vh_params& vhp)
+// read io sequentially, this is used for stdin, pipes, and devices
+static string VHread(const vh_params& vhp, FILE* io)
 {
-	void* h1;
-	if( posix_memalign( &h1, vh_hwreg_width/8, vhp.vh_nint*sizeof(uint32_t) ) != 0 )
-		return string();
-	void* h2;
-	if( posix_memalign( &h2, vh_hwreg_width/8, vhp.vh_nint*sizeof(uint32_t) ) != 0 )
-		return string();
-	void* h3;
-	if( posix_memalign( &h3, vh_hwreg_width/8, vhp.vh_nint*sizeof(uint32_t) ) != 0 )
-		return string();
-	void* h4;
-	if( posix_memalign( &h4, vh_hwreg_width/8, vhp.vh_nint*sizeof(uint32_t) ) != 0 )
+	vh_reader rd( io, vhp.bufsize, vh_nbuf, vhp.lgHugePages );
+	if( !rd.ok() )
 		return string();
 
-	uint32_t* z1 = (uint32_t*)h1;
-	uint32_t* z2 = (uint32_t*)h2;
-	uint32_t* z3 = (uint32_t*)h3;
-	uint32_t* z4 = (uint32_t*)h4;
+	vh_digest dg( vhp );
+	size_t n;
+	do
+	{
+		const void* p = rd.get(n);
+		dg.update( p, n );
+		rd.release();
+	}
+	while( n == vhp.bufsize );
 
-	uint32_t seed = vhp.seed;
-	stateinit( z1, seed, vhp.vh_nint );
-	stateinit( z2, seed, vhp.vh_nint );
-	stateinit( z3, seed, vhp.vh_nint );
-	stateinit( z4, seed, vhp.vh_nint );
+	return dg.final();
+}
 
-	void* map = NULL;
-	if( posix_memalign( &map, vh_hwreg_width/8, vhp.blocksize ) != 0 )
-		return string();
-	vector<uint32_t> state(vhp.vh_nstate);
-	size_t len = 0, bsize;
-	bool lgContinue = true;
-	while( lgContinue )
-	{
-		bsize = fread( map, 1, vhp.blocksize, stdin );
-		if( bsize < vhp.blocksize ) {
-			pad_buffer( (const uint8_t*)map, (uint8_t*)map, bsize, vhp.blocksize );
-			lgContinue = false;
-		}
-		if( vhp.SIMDversion == IS_AVX512 )
-			VectorHashBody512((const v16si*)map, (v16si*)h1, (v16si*)h2, (v16si*)h3, (v16si*)h4, vhp.vh_hash_width);
-		else if( vhp.SIMDversion == IS_AVX2 )
-			VectorHashBody256((const v8si*)map, (v8si*)h1, (v8si*)h2, (v8si*)h3, (v8si*)h4, vhp.vh_hash_width);
-		else if( vhp.SIMDversion == IS_SSE2 )
-			VectorHashBody128((const v4si*)map, (v4si*)h1, (v4si*)h2, (v4si*)h3, (v4si*)h4, vhp.vh_hash_width);
-		else if( vhp.SIMDversion == IS_SCALAR )
-			VectorHashBody32((const uint32_t*)map, (uint32_t*)h1, (uint32_t*)h2, (uint32_t*)h3, (uint32_t*)h4,
-							 vhp.vh_hash_width);
-		else {
-			cerr << "Internal error: impossible value for SIMD version: " << vhp.SIMDversion << "." << endl;
-			exit(1);
+// only regular files can be mapped and report their true size, pipes, devices, and files in /proc
+// (which report a size of 0) need to be read sequentially, as do empty files, which costs nothing
+#if _POSIX_MAPPED_FILES > 0
+inline bool IsMappable(const struct stat& st)
+{
+	return S_ISREG(st.st_mode) && st.st_size > 0;
+}
+#endif
+
+inline bool IsMappable(FILE* io)
+{
+#if _POSIX_MAPPED_FILES > 0
+	struct stat st;
+	return fstat( fileno(io), &st ) != 0 || IsMappable( st );
+#else
+	(void)io;
+	return true;
+#endif
+}
+
+// a regular file, unlike IsMappable this includes empty files
+inline bool IsRegular(FILE* io)
+{
+#if _POSIX_MAPPED_FILES > 0
+	struct stat st;
+	return fstat( fileno(io), &st ) == 0 && S_ISREG(st.st_mode);
+#else
+	(void)io;
+	return true;
+#endif
+}
+
+// the checksums of several widths and seeds over the same data, the data are read only once
+// the states are ordered by width and then by seed, so that the states that only differ in
+// their seed are adjacent and can share the loads of the data
+class vh_multidigest
+{
+	vector<vh_state> st;
+	vector<vh_state*> pst;
+public:
+	explicit vh_multidigest(const vh_params& vhp)
+	{
+		for( auto hw : vhp.all_widths() )
+			for( auto seed : vhp.all_seeds() )
+			{
+				st.push_back( vh_state() );
+				VectorHashInit( &st.back(), seed, vhp.SIMDversion, hw );
+			}
+		for( auto& s : st )
+			pst.push_back( &s );
+	}
+	void update(const void* buf, size_t n)
+	{
+		VectorHashUpdateMulti( pst.data(), pst.size(), buf, n );
+	}
+	vector<string> final()
+	{
+		vector<string> res;
+		for( size_t i=0; i < st.size(); ++i )
+		{
+			uint32_t state[1024/32];
+			VectorHashFinal( &st[i], state );
+			ostringstream hash;
+			for( size_t j=0; j < st[i].hash_width/32; ++j )
+				hash << hex << setfill('0') << setw(8) << state[j];
+			res.push_back( hash.str() );
 		}
-		len += bsize;
-	}
-	posix_memalign_free( map );
-
-	if( vhp.vh_nstate == 1 )
-		VectorHashFinalize_32(len, z1, z2, z3, z4, state.data(), vhp.vh_hash_width);
-	else if( vhp.vh_nstate == 2 )
-		VectorHashFinalize_64(len, z1, z2, z3, z4, state.data(), vhp.vh_hash_width);
-	else if( vhp.vh_nstate == 4 )
-		VectorHashFinalize_128(len, z1, z2, z3, z4, state.data(), vhp.vh_hash_width);
-	else if( vhp.vh_nstate == 8 )
-		VectorHashFinalize_256(len, z1, z2, z3, z4, state.data(), vhp.vh_hash_width);
-	else if( vhp.vh_nstate == 16 )
-		VectorHashFinalize_512(len, z1, z2, z3, z4, state.data(), vhp.vh_hash_width);
-	else if( vhp.vh_nstate == 32 )
-		VectorHashFinalize_1024(len, z1, z2, z3, z4, state.data(), vhp.vh_hash_width);
-	else {
-		cerr << "Internal error: impossible value for vh_nstate: " << vhp.vh_nstate << "." << endl;
-		exit(1);
+		return res;
 	}
+};
 
-	posix_memalign_free( h4 );
-	posix_memalign_free( h3 );
-	posix_memalign_free( h2 );
-	posix_memalign_free( h1 );
-
-	ostringstream hash;
-	for( size_t i=0; i < vhp.vh_nhash; ++i )
-		hash << hex << setfill('0') << setw(8) << state[i];
+//-----------------------------------------------------------------------------
+// Reader based on io_uring (Linux only). The system calls are used directly so
+// that no external library is needed. A fixed number of reads (the queue depth)
+// is kept in flight, each into its own registered buffer. The reads are issued
+// for the files in order, so when the end of a file is near, reading the next
+// file already starts. The buffers are consumed in the order they were issued.
 
-	return hash.str();
-}
+#ifdef VH_HAVE_URING
 
-inline string Escape(const string& s)
+class vh_uring
 {
-	string t;
-	for( size_t p=0; p < s.length(); p++ )
+	int ring;
+	unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+	unsigned *cq_head, *cq_tail, *cq_mask;
+	io_uring_sqe* sqes;
+	io_uring_cqe* cqes;
+	void* sq_ptr;
+	size_t sq_size;
+	void* cq_ptr;
+	size_t cq_size;
+	size_t sqe_size;
+	vh_buffer bufs;
+	size_t bufsize;
+	size_t depth;
+	bool lgFixed;
+	vector<iovec> iov;
+
+	vh_uring(const vh_uring&) = delete;
+	vh_uring& operator=(const vh_uring&) = delete;
+public:
+	// the results of the reads, indexed by slot
+	vector<int> res;
+	vector<char> done;
+
+	vh_uring(size_t bs, size_t qd, bool lgHugePages) : ring(-1), sq_head(nullptr), sq_tail(nullptr), sq_mask(nullptr),
+		sq_array(nullptr), cq_head(nullptr), cq_tail(nullptr), cq_mask(nullptr), sqes(nullptr), cqes(nullptr),
+		sq_ptr(MAP_FAILED), sq_size(0), cq_ptr(MAP_FAILED), cq_size(0), sqe_size(0), bufsize(bs),
+		depth(qd), lgFixed(false), iov(qd), res(qd, 0), done(qd, 0)
 	{
-		if( s[p] == '\\' )
-			t += "\\\\";
-		else if( s[p] == '\n' )
-			t += "\\n";
+		io_uring_params p;
+		memset( &p, 0, sizeof(p) );
+		ring = int(syscall( __NR_io_uring_setup, unsigned(depth), &p ));
+		if( ring < 0 )
+			return;
+		sq_size = p.sq_off.array + p.sq_entries*sizeof(unsigned);
+		cq_size = p.cq_off.cqes + p.cq_entries*sizeof(io_uring_cqe);
+		if( (p.features & IORING_FEAT_SINGLE_MMAP) != 0 )
+			sq_size = cq_size = max(sq_size, cq_size);
+		sq_ptr = mmap( NULL, sq_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ring, IORING_OFF_SQ_RING );
+		if( sq_ptr == MAP_FAILED )
+			return;
+		if( (p.features & IORING_FEAT_SINGLE_MMAP) != 0 )
+			cq_ptr = sq_ptr;
 		else
-			t += s[p];
+		{
+			cq_ptr = mmap( NULL, cq_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ring, IORING_OFF_CQ_RING );
+			if( cq_ptr == MAP_FAILED )
+				return;
+		}
+		sqe_size = p.sq_entries*sizeof(io_uring_sqe);
+		void* s = mmap( NULL, sqe_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ring, IORING_OFF_SQES );
+		if( s == MAP_FAILED )
+			return;
+		sqes = (io_uring_sqe*)s;
+		char* sq = (char*)sq_ptr;
+		sq_head = (unsigned*)(sq + p.sq_off.head);
+		sq_tail = (unsigned*)(sq + p.sq_off.tail);
+		sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+		sq_array = (unsigned*)(sq + p.sq_off.array);
+		char* cq = (char*)cq_ptr;
+		cq_head = (unsigned*)(cq + p.cq_off.head);
+		cq_tail = (unsigned*)(cq + p.cq_off.tail);
+		cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+		cqes = (io_uring_cqe*)(cq + p.cq_off.cqes);
+
+		// the buffers are page aligned, this is more than the SIMD routines need
+		if( !bufs.alloc( depth*bufsize, 4096, lgHugePages ) )
+			return;
+		for( size_t i=0; i < depth; i++ )
+		{
+			iov[i].iov_base = buffer(i);
+			iov[i].iov_len = bufsize;
+		}
+		// registering the buffers can fail, e.g. because of RLIMIT_MEMLOCK, then we use normal reads
+		lgFixed = ( syscall( __NR_io_uring_register, ring, IORING_REGISTER_BUFFERS, iov.data(),
+							 unsigned(depth) ) == 0 );
 	}
-	return t;
-}
+	~vh_uring()
+	{
+		if( sqes != nullptr )
+			munmap( sqes, sqe_size );
+		if( cq_ptr != MAP_FAILED && cq_ptr != sq_ptr )
+			munmap( cq_ptr, cq_size );
+		if( sq_ptr != MAP_FAILED )
+			munmap( sq_ptr, sq_size );
+		if( ring >= 0 )
+			close( ring );
+	}
+	bool ok() const { return bufs.data() != nullptr; }
+	bool fixed() const { return lgFixed; }
+	bool huge() const { return bufs.huge(); }
+	size_t size() const { return depth; }
+	char* buffer(size_t slot) const { return bufs.data() + slot*bufsize; }
+	// queue a read of n bytes at offset off of file fd into buffer slot
+	void read(size_t slot, int fd, uint64_t off, size_t n)
+	{
+		unsigned tail = *sq_tail;
+		unsigned idx = tail & *sq_mask;
+		io_uring_sqe* sqe = &sqes[idx];
+		memset( sqe, 0, sizeof(*sqe) );
+		sqe->fd = fd;
+		sqe->off = off;
+		sqe->user_data = slot;
+		if( lgFixed )
+		{
+			sqe->opcode = IORING_OP_READ_FIXED;
+			sqe->addr = uint64_t(uintptr_t(buffer(slot)));
+			sqe->len = unsigned(n);
+			sqe->buf_index = uint16_t(slot);
+		}
+		else
+		{
+			iov[slot].iov_len = n;
+			sqe->opcode = IORING_OP_READV;
+			sqe->addr = uint64_t(uintptr_t(&iov[slot]));
+			sqe->len = 1;
+		}
+		sq_array[idx] = idx;
+		done[slot] = 0;
+		__atomic_store_n( sq_tail, tail+1, __ATOMIC_RELEASE );
+	}
+	// submit the queued reads and wait until the read into buffer slot has completed
+	bool wait(size_t slot)
+	{
+		while( true )
+		{
+			unsigned head = *cq_head;
+			while( head != __atomic_load_n( cq_tail, __ATOMIC_ACQUIRE ) )
+			{
+				io_uring_cqe* cqe = &cqes[head & *cq_mask];
+				res[cqe->user_data] = cqe->res;
+				done[cqe->user_data] = 1;
+				++head;
+			}
+			__atomic_store_n( cq_head, head, __ATOMIC_RELEASE );
+			if( done[slot] )
+				return true;
+			unsigned nsubmit = *sq_tail - __atomic_load_n( sq_head, __ATOMIC_ACQUIRE );
+			if( syscall( __NR_io_uring_enter, ring, nsubmit, 1u, IORING_ENTER_GETEVENTS, NULL, 0 ) < 0 &&
+				errno != EINTR )
+				return false;
+		}
+	}
+};
 
-inline string DeEscape(const string& s)
+// Checksum a list of files that are opened with openf(i), which returns -1 on failure.
+// For each file closef(i, fd) and report(i, vhsum) are called in order, an empty checksum
+// indicates an error. Returns false if io_uring is not available, nothing was done then.
+template<class O, class C, class R>
+static bool UringFiles(const vh_params& vhp, size_t nfiles, O openf, C closef, R report, bool lgInfo)
 {
-	string t;
-	for( size_t p=0; p < s.length(); )
+	vh_uring ur( vhp.bufsize, vhp.iodepth, vhp.lgHugePages );
+	if( !ur.ok() )
+		return false;
+	if( lgInfo && vhp.lgVerbose )
 	{
-		if( s[p] == '\\' )
+		cout << "using io_uring with queue depth " << dec << ur.size() << ( ur.fixed() ? " and" : " without" );
+		cout << " registered buffers" << ( ur.huge() ? " in huge pages" : "" ) << endl;
+	}
+
+	struct file_info {
+		int fd;
+		bool lgOpened;
+		bool lgRegular;
+		uint64_t size;
+		file_info() : fd(-1), lgOpened(false), lgRegular(false), size(0) {}
+	};
+	struct slot_info {
+		size_t file;
+		uint64_t off;
+		size_t len;
+	};
+	vector<file_info> fi(nfiles);
+	vector<slot_info> si(ur.size());
+	// the next read that will be issued
+	size_t cur_file = 0;
+	uint64_t cur_off = 0;
+	// the slots are used round robin, nbusy of them starting at the first one have reads in flight
+	size_t first = 0, nbusy = 0;
+	// set when waiting for a read failed, no more reads are issued then
+	bool lgRingErr = false;
+
+	auto open_file = [&]( size_t i ) {
+		if( fi[i].lgOpened )
+			return;
+		fi[i].lgOpened = true;
+		fi[i].fd = openf(i);
+		struct stat st;
+		if( fi[i].fd >= 0 && fstat( fi[i].fd, &st ) == 0 )
 		{
-			if( s.substr(p, 2) == "\\n" )
+			// only regular files report their true size, the others are not read through the ring
+			fi[i].lgRegular = IsMappable( st );
+			fi[i].size = fi[i].lgRegular ? uint64_t(st.st_size) : 0;
+		}
+	};
+	// issue reads until all slots are busy
+	auto fill = [&]() {
+		while( !lgRingErr && nbusy < ur.size() && cur_file < nfiles )
+		{
+			open_file( cur_file );
+			if( fi[cur_file].fd < 0 || cur_off >= fi[cur_file].size )
 			{
-				t += "\n";
-				p += 2;
+				++cur_file;
+				cur_off = 0;
+				continue;
 			}
-			else if( s.substr(p, 2) == "\\\\" )
+			size_t slot = (first+nbusy)%ur.size();
+			size_t n = size_t(min(uint64_t(vhp.bufsize), fi[cur_file].size - cur_off));
+			si[slot].file = cur_file;
+			si[slot].off = cur_off;
+			si[slot].len = n;
+			ur.read( slot, fi[cur_file].fd, cur_off, n );
+			cur_off += n;
+			++nbusy;
+		}
+	};
+
+	fill();
+	for( size_t i=0; i < nfiles; i++ )
+	{
+		fill();
+		open_file( i );
+		bool lgQueued = ( i < cur_file || ( i == cur_file && cur_off > 0 ) );
+		if( fi[i].fd >= 0 && ( !fi[i].lgRegular || ( lgRingErr && !lgQueued ) ) )
+		{
+			// read pipes, devices, etc. sequentially from a duplicate, the original is closed by closef,
+			// this is also done for files that were not queued yet when the ring failed
+			int fd = dup( fi[i].fd );
+			FILE* io = ( fd >= 0 ) ? fdopen( fd, "rb" ) : 0;
+			string vhsum = ( io != 0 ) ? VHread( vhp, io ) : string();
+			if( io != 0 )
+				fclose( io );
+			else if( fd >= 0 )
+				close( fd );
+			closef( i, fi[i].fd );
+			report( i, vhsum );
+			continue;
+		}
+		// the reads of this file were lost if the ring failed
+		bool lgOK = ( fi[i].fd >= 0 && !lgRingErr );
+		vh_digest dg( vhp );
+		while( nbusy > 0 && si[first].file == i )
+		{
+			size_t slot = first;
+			if( !ur.wait( slot ) )
 			{
-				t += "\\";
-				p += 2;
+				// the reads in flight are abandoned, their slots are never reused
+				lgRingErr = true;
+				lgOK = false;
+				nbusy = 0;
+				break;
 			}
-			else
+			int r = ur.res[slot];
+			size_t got = ( r > 0 ) ? size_t(r) : 0;
+			// a short read is unusual for regular files, simply read the rest synchronously
+			while( r > 0 && got < si[slot].len )
 			{
-				// this is a syntax error...
-				return string();
+				r = int(pread( fi[i].fd, ur.buffer(slot)+got, si[slot].len-got, off_t(si[slot].off+got) ));
+				if( r > 0 )
+					got += size_t(r);
 			}
+			if( got < si[slot].len )
+				lgOK = false;
+			else if( lgOK )
+				dg.update( ur.buffer(slot), got );
+			first = (first+1)%ur.size();
+			--nbusy;
+			fill();
 		}
-		else
-			t += s[p++];
+		if( fi[i].fd >= 0 )
+			closef( i, fi[i].fd );
+		report( i, ( lgOK ? dg.final() : string() ) );
 	}
-	return t;
+	return true;
 }
 
-inline void PrintSum(const vh_params& vhp, const string& arg, const string& vhsum)
+#endif
+
+#if _POSIX_MAPPED_FILES > 0
+// map n bytes of the file starting at off, and tell the kernel how we will access them
+static char* MapRange(const vh_params& vhp, int fd, size_t n, off_t off)
 {
-	string esc;
-	if( vhp.lgZero )
-		esc = arg;
-	else {
-		esc = Escape(arg);
-		if( esc != arg )
-			cout << '\\';
-	}
-	if( vhp.lgBSDstyle )
-		cout << "VH" << vhp.vh_hash_width << " (" << esc << ") = " << vhsum;
-	else
-		cout << vhsum << " " << vhp.sentinel() << esc;
-	cout << ( vhp.lgZero ? '\0' : '\n' );
+	int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+	// for small files it is cheapest to read everything in a single system call
+	if( vhp.readahead > 0 && n <= vh_populate_max )
+		flags |= MAP_POPULATE;
+#endif
+	char* map = (char*)mmap( NULL, n, PROT_READ, flags, fd, off );
+	if( map == MAP_FAILED || vhp.readahead == 0 || n <= vh_populate_max )
+		return map;
+	// start reading the first part right away so that we do not fault on every page, the
+	// kernel will continue reading ahead from there (adding MADV_SEQUENTIAL made this slower)
+	(void)madvise( map, min(n, vhp.readahead), MADV_WILLNEED );
+	return map;
 }
+#endif
 
-static void PrintHelp(const vh_params& vhp)
+#if _POSIX_MAPPED_FILES > 0
+// read the file with O_DIRECT until the end, this works for block devices as well since
+// the size of the file is not needed; with --verbose the throughput is reported
+static string VHdirect(const vh_params& vhp, FILE* io)
 {
-	cout << "Usage: " << vhp.cmd << " [OPTION]... [FILE]...\n";
+	auto t0 = chrono::steady_clock::now();
+	size_t bufsize = (vhp.bufsize + vh_direct_align - 1)/vh_direct_align*vh_direct_align;
+	vh_reader rd( fileno(io), bufsize, vh_nbuf, vhp.lgHugePages, vhp.lgDropCache );
+	if( !rd.ok() )
+		return string();
+
+	vh_digest dg( vhp );
+	uint64_t len = 0;
+	size_t n;
+	do
+	{
+		const void* p = rd.get(n);
+		dg.update( p, n );
+		rd.release();
+		len += n;
+	}
+	while( n == bufsize );
+	if( rd.error() )
+		return string();
+
+	if( vhp.lgVerbose )
+	{
+		double dt = chrono::duration<double>( chrono::steady_clock::now() - t0 ).count();
+		ostringstream oss;
+		oss << "read " << dec << len << " bytes " << ( rd.direct() ? "with" : "without" ) << " O_DIRECT";
+		oss << ( rd.huge() ? " into huge pages" : "" ) << " in ";
+		oss << fixed << setprecision(3) << dt << " s";
+		if( dt > 0. )
+			oss << " (" << setprecision(1) << double(len)/dt/1048576. << " MiB/s)";
+		oss << "\n";
+		cout << oss.str() << flush;
+	}
+	return dg.final();
+}
+#endif
+
+// call process(buf, n) for consecutive windows of the file io of len bytes, starting at byte start
+template<class P>
+static bool ForEachWindow(const vh_params& vhp, FILE* io, uint64_t len, P process, uint64_t start = 0)
+{
+	size_t window = ( vhp.window > 0 ) ? vhp.window : vh_window_default;
+#if _POSIX_MAPPED_FILES > 0
+	int fd = fileno(io);
+	// the window is a multiple of the page size, so the maps start at a multiple of the window
+	for( uint64_t off=start/window*window; off < len; off += window )
+	{
+		size_t n = size_t(min(uint64_t(window), len-off));
+		char* map = MapRange( vhp, fd, n, off_t(off) );
+		if( map == MAP_FAILED )
+			return false;
+		size_t skip = size_t(max(start, off) - off);
+		process( map + skip, n - skip );
+		munmap( map, n );
+#ifdef POSIX_FADV_DONTNEED
+		// this part of the file will not be read again, other processes may still need it though
+		if( vhp.lgDropCache )
+			(void)posix_fadvise( fd, off_t(off), off_t(n), POSIX_FADV_DONTNEED );
+#endif
+	}
+#else
+	if( fseek( io, long(start), SEEK_SET ) != 0 )
+		return false;
+	vh_buffer map;
+	if( !map.alloc( window, vh_hwreg_width/8, vhp.lgHugePages ) )
+		return false;
+	for( uint64_t off=start; off < len; off += window )
+	{
+		size_t n = size_t(min(uint64_t(window), len-off));
+		if( fread( map.data(), n, 1, io ) != 1 )
+			return false;
+		process( map.data(), n );
+	}
+#endif
+	return true;
+}
+
+static string VHstream(const vh_params& vhp, FILE* io)
+{
+	if( !IsMappable( io ) )
+		return VHread( vhp, io );
+#if _POSIX_MAPPED_FILES > 0
+	if( vhp.lgDirect )
+		return VHdirect( vhp, io );
+#endif
+#ifdef VH_HAVE_URING
+	// small files are read with a single system call anyway, so setting up a ring does not pay off
+	struct stat st;
+	if( vhp.lgUring && fstat( fileno(io), &st ) == 0 && IsMappable( st ) && uint64_t(st.st_size) > vhp.bufsize )
+	{
+		int fd = fileno(io);
+		string vhsum;
+		if( UringFiles( vhp, 1, [fd]( size_t ) { return fd; }, []( size_t, int ) {},
+						[&]( size_t, const string& s ) { vhsum = s; }, false ) )
+			return vhsum;
+	}
+#endif
+#if _POSIX_MAPPED_FILES > 0
+	if( fseeko( io, 0, SEEK_END ) != 0 )
+		return string();
+	off_t fsize = ftello(io);
+#else
+	if( fseek( io, 0, SEEK_END ) != 0 )
+		return string();
+	long fsize = ftell(io);
+#endif
+	if( fsize < 0 )
+		return string();
+	vector<uint32_t> state(vhp.vh_nstate);
+	uint64_t len = uint64_t(fsize);
+	// files that are larger than the window (or do not fit in memory) are read one window at a time
+	if( ( vhp.window > 0 && len > vhp.window ) || len > uint64_t(SIZE_MAX/2) )
+	{
+		vh_state st;
+		VectorHashInit( &st, vhp.seed, vhp.SIMDversion, vhp.vh_hash_width );
+		vector<uint32_t> leaves;
+		auto process = [&]( const void* buf, size_t n ) {
+			if( vhp.lgTree )
+			{
+				// the window is a multiple of the chunk size, so each window holds complete leaves
+				size_t nl = VectorHashTreeLeaves( n, 0 );
+				leaves.resize( leaves.size() + nl*vhp.vh_nhash );
+				VectorHashTreeHashLeaves( buf, n, vhp.seed, &leaves[leaves.size()-nl*vhp.vh_nhash],
+										  vhp.SIMDversion, vhp.vh_hash_width, 0, vhp.nthreads );
+			}
+			else
+				VectorHashUpdate( &st, buf, n, vhp.nthreads );
+		};
+		if( !ForEachWindow( vhp, io, len, process ) )
+			return string();
+		if( vhp.lgTree )
+			VectorHashTreeRoot( leaves.data(), leaves.size()/vhp.vh_nhash, len, vhp.seed, state.data(),
+								vhp.SIMDversion, vhp.vh_hash_width, 0 );
+		else
+			VectorHashFinal( &st, state.data() );
+	}
+	else
+	{
+#if _POSIX_MAPPED_FILES > 0
+		int fd = fileno(io);
+		char* map = ( fsize > 0 ) ? MapRange( vhp, fd, size_t(fsize), 0 ) : nullptr;
+		if( fsize > 0 && map == MAP_FAILED )
+			return string();
+		if( vhp.lgTree )
+			VectorHashTree( map, fsize, vhp.seed, state.data(), vhp.SIMDversion, vhp.vh_hash_width, 0,
+							vhp.nthreads );
+		else
+			VectorHashParallel( map, fsize, vhp.seed, state.data(), vhp.SIMDversion, vhp.vh_hash_width,
+								vhp.nthreads );
+		munmap(map, fsize);
+#else
+		if( fseek( io, 0, SEEK_SET ) != 0 )
+			return string();
+		vh_buffer map;
+		if( fsize > 0 )
+		{
+			if( !map.alloc( fsize, vh_hwreg_width/8, vhp.lgHugePages ) )
+				return string();
+			if( fread( map.data(), fsize, 1, io ) != 1 )
+				return string();
+		}
+		if( vhp.lgTree )
+			VectorHashTree( map.data(), fsize, vhp.seed, state.data(), vhp.SIMDversion, vhp.vh_hash_width, 0,
+							vhp.nthreads );
+		else
+			VectorHashParallel( map.data(), fsize, vhp.seed, state.data(), vhp.SIMDversion, vhp.vh_hash_width,
+								vhp.nthreads );
+#endif
+	}
+
+	ostringstream hash;
+	for( size_t i=0; i < vhp.vh_nhash; ++i )
+		hash << hex << setfill('0') << setw(8) << state[i];
+
+	return hash.str();
+}
+
+// feed all buffers of the reader to the digest, returns false on a read error
+static bool ReadAll(vh_reader& rd, vh_multidigest& dg, size_t bufsize)
+{
+	if( !rd.ok() )
+		return false;
+	size_t n;
+	do
+	{
+		const void* p = rd.get(n);
+		dg.update( p, n );
+		rd.release();
+	}
+	while( n == bufsize );
+	return !rd.error();
+}
+
+// the checksums of all widths and seeds, io == 0 means stdin, an empty result means a read error
+static vector<string> VHmulti(const vh_params& vhp, FILE* io)
+{
+	vh_multidigest dg( vhp );
+	if( io == 0 )
+	{
+		vh_reader rd( stdin, vhp.bufsize, vh_nbuf, vhp.lgHugePages );
+		return ReadAll( rd, dg, vhp.bufsize ) ? dg.final() : vector<string>();
+	}
+	if( !IsMappable( io ) )
+	{
+		vh_reader rd( io, vhp.bufsize, vh_nbuf, vhp.lgHugePages );
+		return ReadAll( rd, dg, vhp.bufsize ) ? dg.final() : vector<string>();
+	}
+#if _POSIX_MAPPED_FILES > 0
+	if( vhp.lgDirect )
+	{
+		size_t bufsize = (vhp.bufsize + vh_direct_align - 1)/vh_direct_align*vh_direct_align;
+		vh_reader rd( fileno(io), bufsize, vh_nbuf, vhp.lgHugePages, vhp.lgDropCache );
+		return ReadAll( rd, dg, bufsize ) ? dg.final() : vector<string>();
+	}
+	off_t fsize = ( fseeko( io, 0, SEEK_END ) == 0 ) ? ftello(io) : -1;
+#else
+	long fsize = ( fseek( io, 0, SEEK_END ) == 0 ) ? ftell(io) : -1;
+#endif
+	if( fsize < 0 )
+		return vector<string>();
+	auto process = [&]( const void* buf, size_t n ) { dg.update( buf, n ); };
+	if( !ForEachWindow( vhp, io, uint64_t(fsize), process ) )
+		return vector<string>();
+	return dg.final();
+}
+
+//-----------------------------------------------------------------------------
+// Anchors. A saved state is only valid for the input it was made from, but
+// rereading all of the input to prove that it is unchanged would defeat the
+// purpose of saving the state. Instead the checksum of the first and last
+// vh_anchor_size bytes of the processed part (the anchor) is stored along with
+// the state, and compared before the state is used again.
+
+// the number of bytes at either end of the processed part that are verified
+static const size_t vh_anchor_size = size_t(64) << 10;
+// the anchor is a 128-bit checksum using this seed
+static const uint32_t vh_anchor_seed = 0x416e6368;
+// the number of bytes needed to store the anchor
+static const size_t vh_anchor_bytes = 16;
+
+// read n bytes at offset off
+static bool ReadAt(FILE* io, uint64_t off, char* buf, size_t n)
+{
+#if _POSIX_MAPPED_FILES > 0
+	if( fseeko( io, off_t(off), SEEK_SET ) != 0 )
+		return false;
+#else
+	if( fseek( io, long(off), SEEK_SET ) != 0 )
+		return false;
+#endif
+	return n == 0 || fread( buf, n, 1, io ) == 1;
+}
+
+// the anchor of head and tail, the bytes at either end of the processed part
+inline void AnchorSum(const vh_params& vhp, const char* head, size_t nhead, const char* tail, size_t ntail,
+					  uint32_t anchor[])
+{
+	vector<char> buf(head, head+nhead);
+	buf.insert( buf.end(), tail, tail+ntail );
+	VectorHash( buf.data(), buf.size(), vh_anchor_seed, anchor, vhp.SIMDversion, 128 );
+}
+
+// the anchor of the first len bytes of the file io, returns false on a read error;
+// the file position is restored, since the file may be in the middle of being read
+static bool AnchorSum(const vh_params& vhp, FILE* io, uint64_t len, uint32_t anchor[])
+{
+	// the head and tail overlap in short files, then the whole prefix is used
+	size_t nhead = size_t(min(len, uint64_t(vh_anchor_size)));
+	size_t ntail = size_t(min(len-nhead, uint64_t(vh_anchor_size)));
+	vector<char> buf(nhead+ntail);
+#if _POSIX_MAPPED_FILES > 0
+	off_t pos = ftello( io );
+#else
+	long pos = ftell( io );
+#endif
+	if( pos < 0 )
+		return false;
+	bool lgOK = ReadAt( io, 0, buf.data(), nhead ) && ReadAt( io, len-ntail, buf.data()+nhead, ntail );
+	if( !ReadAt( io, uint64_t(pos), 0, 0 ) || !lgOK )
+		return false;
+	AnchorSum( vhp, buf.data(), nhead, buf.data()+nhead, ntail, anchor );
+	return true;
+}
+
+// collects the anchor of a stream that cannot be reread
+class vh_anchor
+{
+	vector<char> head;
+	vector<char> tail;
+public:
+	void update(const void* buf, size_t n)
+	{
+		const char* p = (const char*)buf;
+		size_t k = min(n, vh_anchor_size - head.size());
+		head.insert( head.end(), p, p+k );
+		p += k;
+		n -= k;
+		// only the last vh_anchor_size bytes are kept
+		if( n >= vh_anchor_size )
+			tail.assign( p+n-vh_anchor_size, p+n );
+		else
+		{
+			tail.insert( tail.end(), p, p+n );
+			if( tail.size() > vh_anchor_size )
+				tail.erase( tail.begin(), tail.end()-vh_anchor_size );
+		}
+	}
+	void sum(const vh_params& vhp, uint32_t anchor[]) const
+	{
+		AnchorSum( vhp, head.data(), head.size(), tail.data(), tail.size(), anchor );
+	}
+};
+
+//-----------------------------------------------------------------------------
+// Checkpoints. With --checkpoint the state of the calculation is saved to a file
+// at regular intervals, and at the end. With --resume a calculation that was
+// interrupted continues from the saved state, so that only the remainder of the
+// input needs to be read. The file is replaced atomically, so that a crash while
+// saving leaves the previous checkpoint intact.
+//
+// The checkpoint holds the anchor, the size of the input (or vh_size_unknown
+// for a pipe), and the saved state. A calculation is only resumed when the input
+// has the same size and anchor; a pipe is read up to the saved offset to check
+// the anchor.
+
+static const uint64_t vh_size_unknown = UINT64_MAX;
+static const size_t vh_checkpoint_header = vh_anchor_bytes + 8;
+
+// replace the contents of the file path by the n bytes in buf, either completely or not at all
+static bool ReplaceFile(const string& path, const void* buf, size_t n)
+{
+	string tmp = path + ".tmp";
+	FILE* io = fopen( tmp.c_str(), "wb" );
+	if( io == 0 )
+		return false;
+	bool lgOK = ( fwrite( buf, n, 1, io ) == 1 && fflush( io ) == 0 );
+#if defined(_POSIX_FSYNC) && _POSIX_FSYNC > 0
+	// make sure the data is on disk before the old file is replaced
+	lgOK = lgOK && ( fsync( fileno(io) ) == 0 );
+#endif
+	lgOK = ( fclose( io ) == 0 ) && lgOK;
+	if( !lgOK || rename( tmp.c_str(), path.c_str() ) != 0 )
+	{
+		remove( tmp.c_str() );
+		return false;
+	}
+	return true;
+}
+
+static bool SaveCheckpoint(const vh_params& vhp, const vh_state& st, const uint32_t anchor[], uint64_t size)
+{
+	uint8_t buf[vh_checkpoint_header+VH_STATE_SAVE_MAX];
+	store_words( buf, anchor, 4 );
+	store_uint64( buf+vh_anchor_bytes, size );
+	size_t n = VectorHashStateSave( &st, buf+vh_checkpoint_header, VH_STATE_SAVE_MAX );
+	return ReplaceFile( vhp.checkpoint, buf, vh_checkpoint_header+n );
+}
+
+// returns false if the checkpoint file is unusable, a missing file starts a new calculation
+// with an empty state, the anchor and size of the input it was made from are returned as well
+static bool LoadCheckpoint(const vh_params& vhp, vh_state& st, uint32_t anchor[], uint64_t& size)
+{
+	VectorHashInit( &st, vhp.seed, vhp.SIMDversion, vhp.vh_hash_width );
+	if( !vhp.lgResume )
+		return true;
+	FILE* io = fopen( vhp.checkpoint.c_str(), "rb" );
+	if( io == 0 )
+		return ( errno == ENOENT );
+	uint8_t buf[vh_checkpoint_header+VH_STATE_SAVE_MAX+1];
+	size_t n = fread( buf, 1, sizeof(buf), io );
+	fclose( io );
+	vh_state ck;
+	if( n < vh_checkpoint_header ||
+		VectorHashStateLoad( &ck, buf+vh_checkpoint_header, n-vh_checkpoint_header ) != 0 )
+		return false;
+	if( ck.hash_width != vhp.vh_hash_width || ck.seed != vhp.seed )
+		return false;
+	load_words( buf, anchor, 4 );
+	size = load_uint64( buf+vh_anchor_bytes );
+	ck.simd = vhp.SIMDversion;
+	st = ck;
+	return true;
+}
+
+// the checksum of io (0 means stdin), continuing from the checkpoint when resuming
+static string VHcheckpoint(vh_params& vhp, const string& arg, FILE* io)
+{
+	vh_state st;
+	uint32_t saved[4];
+	uint64_t savedsize = 0;
+	if( !LoadCheckpoint( vhp, st, saved, savedsize ) )
+	{
+		cerr << vhp.cmd << ": " << escfn(vhp.checkpoint) << ": invalid checkpoint for this calculation\n";
+		vhp.returncode = 1;
+		return string();
+	}
+	auto mismatch = [&]() {
+		cerr << vhp.cmd << ": " << escfn(arg) << ": the input does not match the checkpoint\n";
+		vhp.returncode = 1;
+		return string();
+	};
+
+	// stdin that is redirected from a file is handled like any other file
+	bool lgStream = ( io == 0 && !IsMappable( stdin ) );
+	if( io == 0 && !lgStream )
+		io = stdin;
+	uint64_t size = vh_size_unknown;
+	if( !lgStream )
+	{
+#if _POSIX_MAPPED_FILES > 0
+		off_t fsize = ( fseeko( io, 0, SEEK_END ) == 0 ) ? ftello(io) : -1;
+#else
+		long fsize = ( fseek( io, 0, SEEK_END ) == 0 ) ? ftell(io) : -1;
+#endif
+		if( fsize < 0 )
+		{
+			cerr << vhp.cmd << ": " << escfn(arg) << ": read error\n";
+			vhp.returncode = 1;
+			return string();
+		}
+		size = uint64_t(fsize);
+	}
+	// a checkpoint made from a pipe does not know the size, then only the anchor is checked,
+	// a file that is too short is reported below
+	bool lgResumed = ( st.len > 0 );
+	if( lgResumed && !lgStream && size >= st.len )
+	{
+		uint32_t anchor[4];
+		if( ( savedsize != vh_size_unknown && savedsize != size ) ||
+			!AnchorSum( vhp, io, st.len, anchor ) || memcmp( saved, anchor, sizeof(anchor) ) != 0 )
+			return mismatch();
+	}
+
+	vh_anchor ac;
+	auto save = [&]() {
+		uint32_t anchor[4];
+		if( lgStream )
+			ac.sum( vhp, anchor );
+		else if( !AnchorSum( vhp, io, st.len, anchor ) )
+			return false;
+		return SaveCheckpoint( vhp, st, anchor, size );
+	};
+	auto last = chrono::steady_clock::now();
+	bool lgSaveErr = false;
+	auto process = [&]( const void* buf, size_t n ) {
+		VectorHashUpdate( &st, buf, n, vhp.nthreads );
+		if( lgStream )
+			ac.update( buf, n );
+		auto now = chrono::steady_clock::now();
+		if( chrono::duration<double>(now - last).count() >= vh_checkpoint_interval )
+		{
+			lgSaveErr = lgSaveErr || !save();
+			last = now;
+		}
+	};
+
+	bool lgReadErr = false;
+	if( lgStream )
+	{
+		// a pipe cannot be positioned, so the part that was already processed is read again,
+		// this is also used to check that it is the same input
+		vh_reader rd( stdin, vhp.bufsize, vh_nbuf, vhp.lgHugePages );
+		if( !rd.ok() )
+			return string();
+		uint64_t skip = st.len;
+		bool lgMismatch = false;
+		size_t n;
+		do
+		{
+			const char* p = (const char*)rd.get(n);
+			size_t k = size_t(min(uint64_t(n), skip));
+			ac.update( p, k );
+			skip -= k;
+			if( lgResumed && skip == 0 && !lgMismatch )
+			{
+				uint32_t anchor[4];
+				ac.sum( vhp, anchor );
+				lgMismatch = ( memcmp( saved, anchor, sizeof(anchor) ) != 0 );
+				lgResumed = false;
+			}
+			if( n > k && !lgMismatch )
+				process( p + k, n - k );
+			rd.release();
+		}
+		while( n == vhp.bufsize && !lgMismatch );
+		if( lgMismatch )
+			return mismatch();
+		lgReadErr = rd.error() || skip > 0;
+	}
+	else
+	{
+		lgReadErr = ( size < st.len || !ForEachWindow( vhp, io, size, process, st.len ) );
+	}
+	if( lgReadErr )
+	{
+		cerr << vhp.cmd << ": " << escfn(arg) << ": read error or input shorter than the checkpoint\n";
+		vhp.returncode = 1;
+		return string();
+	}
+
+	// the final state is kept, so that a completed calculation is not repeated
+	if( lgSaveErr || !save() )
+	{
+		cerr << vhp.cmd << ": " << escfn(vhp.checkpoint) << ": cannot write checkpoint\n";
+		vhp.returncode = 1;
+	}
+
+	vector<uint32_t> state(vhp.vh_nstate);
+	VectorHashFinal( &st, state.data() );
+	ostringstream hash;
+	for( size_t i=0; i < vhp.vh_nhash; ++i )
+		hash << hex << setfill('0') << setw(8) << state[i];
+	return hash.str();
+}
+
+//-----------------------------------------------------------------------------
+// Incremental checksums of files that only grow (logs etc.). With --incremental
+// the state before finalization is stored in the sidecar FILE.vhstate, together
+// with the anchor. The next run only reads the bytes that were appended since.
+// When the file became shorter or the anchor no longer matches, the file was
+// rewritten or replaced and it is checksummed from the start. Changes in the
+// middle of the prefix go unnoticed; use a normal run to check for those.
+
+inline string Sidecar(const string& arg)
+{
+	return arg + ".vhstate";
+}
+
+// restore the state saved in the sidecar when the file still starts with the same prefix
+static bool LoadSidecar(const vh_params& vhp, const string& arg, FILE* io, uint64_t fsize, vh_state& st)
+{
+	FILE* sc = fopen( Sidecar(arg).c_str(), "rb" );
+	if( sc == 0 )
+		return false;
+	uint8_t buf[vh_anchor_bytes+VH_STATE_SAVE_MAX+1];
+	size_t n = fread( buf, 1, sizeof(buf), sc );
+	fclose( sc );
+	vh_state ck;
+	if( n < vh_anchor_bytes || VectorHashStateLoad( &ck, buf+vh_anchor_bytes, n-vh_anchor_bytes ) != 0 )
+		return false;
+	if( ck.hash_width != vhp.vh_hash_width || ck.seed != vhp.seed || ck.len > fsize )
+		return false;
+	uint32_t saved[4], anchor[4];
+	load_words( buf, saved, 4 );
+	if( !AnchorSum( vhp, io, ck.len, anchor ) || memcmp( saved, anchor, sizeof(anchor) ) != 0 )
+		return false;
+	ck.simd = vhp.SIMDversion;
+	st = ck;
+	return true;
+}
+
+static bool SaveSidecar(const vh_params& vhp, const string& arg, FILE* io, const vh_state& st)
+{
+	uint8_t buf[vh_anchor_bytes+VH_STATE_SAVE_MAX];
+	uint32_t anchor[4];
+	if( !AnchorSum( vhp, io, st.len, anchor ) )
+		return false;
+	store_words( buf, anchor, 4 );
+	size_t n = VectorHashStateSave( &st, buf+vh_anchor_bytes, VH_STATE_SAVE_MAX );
+	return ReplaceFile( Sidecar(arg), buf, vh_anchor_bytes+n );
+}
+
+// the checksum of the file io, only reading the part that was appended since the previous run
+static string VHincremental(vh_params& vhp, const string& arg, FILE* io)
+{
+	// a pipe or device cannot be read again from the saved offset
+	if( !IsRegular( io ) )
+	{
+		cerr << vhp.cmd << ": " << escfn(arg) << ": only regular files can be checksummed with --incremental\n";
+		vhp.returncode = 1;
+		return string();
+	}
+#if _POSIX_MAPPED_FILES > 0
+	off_t fsize = ( fseeko( io, 0, SEEK_END ) == 0 ) ? ftello(io) : -1;
+#else
+	long fsize = ( fseek( io, 0, SEEK_END ) == 0 ) ? ftell(io) : -1;
+#endif
+	if( fsize < 0 )
+	{
+		cerr << vhp.cmd << ": " << escfn(arg) << ": read error\n";
+		vhp.returncode = 1;
+		return string();
+	}
+
+	vh_state st;
+	if( !LoadSidecar( vhp, arg, io, uint64_t(fsize), st ) )
+	{
+		if( vhp.lgVerbose )
+			cout << "no usable state for " << escfn(arg) << ", reading it from the start." << endl;
+		VectorHashInit( &st, vhp.seed, vhp.SIMDversion, vhp.vh_hash_width );
+	}
+	else if( vhp.lgVerbose )
+		cout << "resuming " << escfn(arg) << " at offset " << dec << st.len << "." << endl;
+
+	auto process = [&]( const void* buf, size_t n ) { VectorHashUpdate( &st, buf, n, vhp.nthreads ); };
+	if( !ForEachWindow( vhp, io, uint64_t(fsize), process, st.len ) )
+	{
+		cerr << vhp.cmd << ": " << escfn(arg) << ": read error\n";
+		vhp.returncode = 1;
+		return string();
+	}
+
+	if( !SaveSidecar( vhp, arg, io, st ) )
+	{
+		cerr << vhp.cmd << ": " << escfn(Sidecar(arg)) << ": cannot write state\n";
+		vhp.returncode = 1;
+	}
+
+	vector<uint32_t> state(vhp.vh_nstate);
+	VectorHashFinal( &st, state.data() );
+	ostringstream hash;
+	for( size_t i=0; i < vhp.vh_nhash; ++i )
+		hash << hex << setfill('0') << setw(8) << state[i];
+	return hash.str();
+}
+
+//-----------------------------------------------------------------------------
+// Chunk index. With --index the file is split into chunks of a fixed size, and
+// the checksum of each chunk is stored in the sidecar FILE.vhidx, together with
+// the checksum of the whole file. Both are computed from the same read of the
+// file, the chunks are checksummed in parallel with --threads. Afterwards a range
+// of the file can be verified by reading only the chunks that overlap it, and
+// comparing the indexes of two copies lists the ranges in which they differ.
+//
+// The sidecar consists of (all numbers little-endian): the magic "VHIX", the
+// version, the checksum width, the seed, the chunk size and the file length (the
+// last two are 64-bit), the checksum of the whole file, the checksums of all
+// chunks, and finally a 32-bit check value over all of the preceding data.
+
+static const char vh_index_magic[] = "VHIX";
+static const uint32_t vh_index_version = 1;
+static const size_t vh_index_header = 32;
+// the seed used for the check value
+static const uint32_t vh_index_seed = 0x56486978;
+
+struct vh_index {
+	size_t hw;
+	uint32_t seed;
+	size_t chunk;
+	uint64_t len;
+	vector<uint32_t> whole;  // the checksum of the whole file
+	vector<uint32_t> leaves; // the checksums of the chunks, back to back
+	size_t nw() const { return hw/32; }
+	size_t nchunks() const { return leaves.size()/nw(); }
+	// the number of bytes in chunk i
+	uint64_t chunklen(size_t i) const { return min(uint64_t(chunk), len - min(len, uint64_t(i)*chunk)); }
+};
+
+static bool WriteIndex(const string& path, const vh_index& idx)
+{
+	vector<uint8_t> buf(vh_index_header + (1+idx.nchunks())*idx.hw/8 + sizeof(uint32_t));
+	uint8_t* p = buf.data();
+	memcpy( p, vh_index_magic, 4 );
+	uint32_t hdr[3] = { vh_index_version, uint32_t(idx.hw), idx.seed };
+	store_words( p+4, hdr, 3 );
+	store_uint64( p+16, idx.chunk );
+	store_uint64( p+24, idx.len );
+	p += vh_index_header;
+	store_words( p, idx.whole.data(), idx.nw() );
+	p += idx.hw/8;
+	store_words( p, idx.leaves.data(), idx.leaves.size() );
+	p += idx.leaves.size()*sizeof(uint32_t);
+	uint32_t check;
+	VectorHash( buf.data(), size_t(p-buf.data()), vh_index_seed, &check, IS_SCALAR, 32 );
+	store_words( p, &check, 1 );
+	return ReplaceFile( path, buf.data(), buf.size() );
+}
+
+// returns false if path cannot be read or does not hold a valid index
+static bool ReadIndex(const string& path, vh_index& idx)
+{
+	FILE* io = fopen( path.c_str(), "rb" );
+	if( io == 0 )
+		return false;
+	vector<uint8_t> buf;
+	uint8_t tmp[65536];
+	size_t n;
+	while( (n = fread( tmp, 1, sizeof(tmp), io )) > 0 )
+		buf.insert( buf.end(), tmp, tmp+n );
+	bool lgErr = ( ferror( io ) != 0 );
+	fclose( io );
+	if( lgErr || buf.size() < vh_index_header+sizeof(uint32_t) || memcmp( buf.data(), vh_index_magic, 4 ) != 0 )
+		return false;
+	const uint8_t* p = buf.data();
+	uint32_t hdr[3];
+	load_words( p+4, hdr, 3 );
+	idx.hw = hdr[1];
+	idx.seed = hdr[2];
+	uint64_t chunk = load_uint64( p+16 );
+	idx.len = load_uint64( p+24 );
+	if( hdr[0] != vh_index_version || idx.hw < 32 || idx.hw > 1024 || idx.hw%32 != 0 || chunk == 0 ||
+		chunk > uint64_t(SIZE_MAX) )
+		return false;
+	idx.chunk = size_t(chunk);
+	uint64_t nchunks = ( idx.len == 0 ) ? 1 : (idx.len-1)/chunk + 1;
+	size_t nbody = buf.size() - vh_index_header - sizeof(uint32_t);
+	if( nbody%(idx.hw/8) != 0 || nbody/(idx.hw/8) != nchunks+1 )
+		return false;
+	uint32_t check, saved;
+	VectorHash( p, buf.size()-sizeof(uint32_t), vh_index_seed, &check, IS_SCALAR, 32 );
+	load_words( p+buf.size()-sizeof(uint32_t), &saved, 1 );
+	if( check != saved )
+		return false;
+	p += vh_index_header;
+	idx.whole.resize( idx.nw() );
+	load_words( p, idx.whole.data(), idx.nw() );
+	idx.leaves.resize( size_t(nchunks)*idx.nw() );
+	load_words( p+idx.hw/8, idx.leaves.data(), idx.leaves.size() );
+	return true;
+}
+
+// calculates the checksums of consecutive chunks, the data may be passed in pieces of any size
+class vh_chunker
+{
+	const vh_params& vhp;
+	size_t hw;
+	uint32_t seed;
+	size_t chunk;
+	vh_state part; // the chunk that is being filled
+	void flush()
+	{
+		leaves.resize( leaves.size() + hw/32 );
+		VectorHashFinal( &part, &leaves[leaves.size()-hw/32] );
+		VectorHashInit( &part, seed, vhp.SIMDversion, hw );
+	}
+public:
+	vector<uint32_t> leaves;
+	vh_chunker(const vh_params& p, size_t w, uint32_t s, size_t c) : vhp(p), hw(w), seed(s), chunk(c)
+	{
+		VectorHashInit( &part, seed, vhp.SIMDversion, hw );
+	}
+	void update(const void* buf, size_t n)
+	{
+		const uint8_t* p = (const uint8_t*)buf;
+		while( n > 0 )
+		{
+			if( part.len > 0 || n < chunk )
+			{
+				size_t k = min(n, chunk - size_t(part.len));
+				VectorHashUpdate( &part, p, k );
+				p += k;
+				n -= k;
+				if( part.len == chunk )
+					flush();
+			}
+			else
+			{
+				// complete chunks are checksummed in parallel
+				size_t m = n/chunk;
+				leaves.resize( leaves.size() + m*hw/32 );
+				VectorHashTreeHashLeaves( p, m*chunk, seed, &leaves[leaves.size()-m*hw/32], vhp.SIMDversion, hw,
+										  chunk, vhp.nthreads );
+				p += m*chunk;
+				n -= m*chunk;
+			}
+		}
+	}
+	// an empty file has a single empty chunk
+	void final()
+	{
+		if( part.len > 0 || leaves.empty() )
+			flush();
+	}
+};
+
+inline string IndexFile(const string& arg)
+{
+	return arg + ".vhidx";
+}
+
+// the checksum of the file io, the index is written to FILE.vhidx
+static string VHindex(vh_params& vhp, const string& arg, FILE* io)
+{
+	// the index records the length of the file, so it cannot be made for a pipe or device
+	if( !IsRegular( io ) )
+	{
+		cerr << vhp.cmd << ": " << escfn(arg) << ": only regular files can be checksummed with --index\n";
+		vhp.returncode = 1;
+		return string();
+	}
+#if _POSIX_MAPPED_FILES > 0
+	off_t fsize = ( fseeko( io, 0, SEEK_END ) == 0 ) ? ftello(io) : -1;
+#else
+	long fsize = ( fseek( io, 0, SEEK_END ) == 0 ) ? ftell(io) : -1;
+#endif
+	if( fsize < 0 )
+	{
+		cerr << vhp.cmd << ": " << escfn(arg) << ": read error\n";
+		vhp.returncode = 1;
+		return string();
+	}
+
+	vh_index idx;
+	idx.hw = vhp.vh_hash_width;
+	idx.seed = vhp.seed;
+	idx.chunk = vhp.indexchunk;
+	idx.len = uint64_t(fsize);
+	vh_chunker ch( vhp, idx.hw, idx.seed, idx.chunk );
+	vh_state st;
+	VectorHashInit( &st, vhp.seed, vhp.SIMDversion, vhp.vh_hash_width );
+	auto process = [&]( const void* buf, size_t n ) {
+		ch.update( buf, n );
+		VectorHashUpdate( &st, buf, n, vhp.nthreads );
+	};
+	if( !ForEachWindow( vhp, io, idx.len, process ) )
+	{
+		cerr << vhp.cmd << ": " << escfn(arg) << ": read error\n";
+		vhp.returncode = 1;
+		return string();
+	}
+	ch.final();
+	idx.leaves.swap( ch.leaves );
+	idx.whole.resize( vhp.vh_nstate );
+	VectorHashFinal( &st, idx.whole.data() );
+
+	if( !WriteIndex( IndexFile(arg), idx ) )
+	{
+		cerr << vhp.cmd << ": " << escfn(IndexFile(arg)) << ": cannot write index\n";
+		vhp.returncode = 1;
+	}
+
+	ostringstream hash;
+	for( size_t i=0; i < vhp.vh_nhash; ++i )
+		hash << hex << setfill('0') << setw(8) << idx.whole[i];
+	return hash.str();
+}
+
+// print the ranges of the chunks for which bad[i] is set, adjacent chunks are merged
+static void PrintRanges(const vh_params& vhp, const string& prefix, const vector<bool>& bad, size_t first,
+						const vh_index& idx, const string& suffix)
+{
+	for( size_t i=0; i < bad.size(); )
+	{
+		if( !bad[i] )
+		{
+			++i;
+			continue;
+		}
+		size_t j = i;
+		while( j < bad.size() && bad[j] )
+			++j;
+		uint64_t off = uint64_t(first+i)*idx.chunk;
+		uint64_t len = uint64_t(j-i-1)*idx.chunk + idx.chunklen(first+j-1);
+		cout << prefix << dec << off << ":" << len << suffix << ( vhp.lgZero ? '\0' : '\n' );
+		i = j;
+	}
+}
+
+// verify the chunks of FILE that overlap the range given with --verify-range
+static void VerifyRange(vh_params& vhp, const string& arg)
+{
+	vh_index idx;
+	if( !ReadIndex( IndexFile(arg), idx ) )
+	{
+		cerr << vhp.cmd << ": " << escfn(IndexFile(arg)) << ": missing or invalid index\n";
+		vhp.returncode = 1;
+		return;
+	}
+	if( vhp.range_off + vhp.range_len > idx.len || vhp.range_off + vhp.range_len < vhp.range_off )
+	{
+		cerr << vhp.cmd << ": " << escfn(arg) << ": the range exceeds the indexed length of " << dec << idx.len
+			 << " bytes\n";
+		vhp.returncode = 1;
+		return;
+	}
+	FILE* io = fopen( arg.c_str(), vhp.option().c_str() );
+	if( io == 0 )
+	{
+		cerr << vhp.cmd << ": " << escfn(arg) << ": No such file or directory\n";
+		vhp.returncode = 1;
+		return;
+	}
+#if _POSIX_MAPPED_FILES > 0
+	off_t fsize = ( fseeko( io, 0, SEEK_END ) == 0 ) ? ftello(io) : -1;
+#else
+	long fsize = ( fseek( io, 0, SEEK_END ) == 0 ) ? ftell(io) : -1;
+#endif
+
+	// only the chunks that overlap the range are read
+	size_t first = size_t(vhp.range_off/idx.chunk);
+	size_t last = ( vhp.range_len == 0 ) ? first :
+		size_t((vhp.range_off + vhp.range_len - 1)/idx.chunk) + 1;
+	uint64_t start = uint64_t(first)*idx.chunk;
+	uint64_t end = min(uint64_t(last)*idx.chunk, idx.len);
+	vh_chunker ch( vhp, idx.hw, idx.seed, idx.chunk );
+	auto process = [&]( const void* buf, size_t n ) { ch.update( buf, n ); };
+	bool lgReadErr = ( fsize < 0 );
+	if( !lgReadErr && min(end, uint64_t(fsize)) > start )
+		lgReadErr = !ForEachWindow( vhp, io, min(end, uint64_t(fsize)), process, start );
+	fclose( io );
+	if( lgReadErr )
+	{
+		cerr << vhp.cmd << ": " << escfn(arg) << ": read error\n";
+		vhp.returncode = 1;
+		return;
+	}
+	if( end > start )
+		ch.final();
+
+	// a chunk fails when its checksum differs, or when the file became shorter
+	vector<bool> bad(last-first);
+	size_t nw = idx.nw();
+	for( size_t i=first; i < last; ++i )
+	{
+		uint64_t cend = uint64_t(i)*idx.chunk + idx.chunklen(i);
+		bad[i-first] = ( cend > uint64_t(fsize) || (i-first+1)*nw > ch.leaves.size() ||
+						 memcmp( &ch.leaves[(i-first)*nw], &idx.leaves[i*nw], nw*sizeof(uint32_t) ) != 0 );
+	}
+	if( uint64_t(fsize) != idx.len && !vhp.lgStatusOnly )
+		cerr << vhp.cmd << ": WARNING: " << escfn(arg) << ": the size differs from the index\n";
+	if( find( bad.begin(), bad.end(), true ) != bad.end() )
+	{
+		if( !vhp.lgStatusOnly )
+			PrintRanges( vhp, arg + ": ", bad, first, idx, " FAILED" );
+		vhp.returncode = 1;
+	}
+	else if( !vhp.lgStatusOnly && !vhp.lgQuiet )
+		cout << arg << ": OK" << ( vhp.lgZero ? '\0' : '\n' );
+}
+
+// list the ranges in which the files described by two indexes differ
+static void DiffIndex(vh_params& vhp, const string& arg1, const string& arg2)
+{
+	vh_index idx[2];
+	const string* arg[2] = { &arg1, &arg2 };
+	for( size_t k=0; k < 2; ++k )
+	{
+		if( !ReadIndex( *arg[k], idx[k] ) )
+		{
+			cerr << vhp.cmd << ": " << escfn(*arg[k]) << ": missing or invalid index\n";
+			vhp.returncode = 2;
+			return;
+		}
+	}
+	if( idx[0].hw != idx[1].hw || idx[0].seed != idx[1].seed || idx[0].chunk != idx[1].chunk )
+	{
+		cerr << vhp.cmd << ": the indexes were made with a different length, seed, or chunk size\n";
+		vhp.returncode = 2;
+		return;
+	}
+
+	// the ranges are given for the longer file, chunks beyond the end of the shorter file always differ
+	const vh_index& lg = ( idx[0].len >= idx[1].len ) ? idx[0] : idx[1];
+	const vh_index& sh = ( idx[0].len >= idx[1].len ) ? idx[1] : idx[0];
+	size_t nw = lg.nw();
+	vector<bool> bad(lg.nchunks());
+	for( size_t i=0; i < bad.size(); ++i )
+		bad[i] = ( i >= sh.nchunks() || sh.chunklen(i) != lg.chunklen(i) ||
+				   memcmp( &sh.leaves[i*nw], &lg.leaves[i*nw], nw*sizeof(uint32_t) ) != 0 );
+	if( find( bad.begin(), bad.end(), true ) != bad.end() )
+	{
+		if( !vhp.lgStatusOnly )
+			PrintRanges( vhp, "", bad, 0, lg, "" );
+		vhp.returncode = 1;
+	}
+}
+
+inline string Escape(const string& s)
+{
+	string t;
+	for( size_t p=0; p < s.length(); p++ )
+	{
+		if( s[p] == '\\' )
+			t += "\\\\";
+		else if( s[p] == '\n' )
+			t += "\\n";
+		else
+			t += s[p];
+	}
+	return t;
+}
+
+inline string DeEscape(const string& s)
+{
+	string t;
+	for( size_t p=0; p < s.length(); )
+	{
+		if( s[p] == '\\' )
+		{
+			if( s.substr(p, 2) == "\\n" )
+			{
+				t += "\n";
+				p += 2;
+			}
+			else if( s.substr(p, 2) == "\\\\" )
+			{
+				t += "\\";
+				p += 2;
+			}
+			else
+			{
+				// this is a syntax error...
+				return string();
+			}
+		}
+		else
+			t += s[p++];
+	}
+	return t;
+}
+
+inline void PrintSum(const vh_params& vhp, const string& arg, const string& vhsum)
+{
+	string esc;
+	if( vhp.lgZero )
+		esc = arg;
+	else {
+		esc = Escape(arg);
+		if( esc != arg )
+			cout << '\\';
+	}
+	if( vhp.lgBSDstyle )
+		cout << vhp.name << " (" << esc << ") = " << vhsum;
+	else
+		cout << vhsum << " " << vhp.sentinel() << esc;
+	cout << ( vhp.lgZero ? '\0' : '\n' );
+}
+
+static void PrintHelp(const vh_params& vhp)
+{
+	cout << "Usage: " << vhp.cmd << " [OPTION]... [FILE]...\n";
 	cout << "Print vectorized hash (" << vhp.vh_hash_width << "-bit) checksums.\n";
 	cout << endl;
 	cout << "With no FILE, or when FILE is -, read standard input.\n";
@@ -443,15 +2068,51 @@ static void PrintHelp(const vh_params& vhp)
 	cout << "  -t, --text            read FILE in text mode (default)\n";
 	cout << "  -z, --zero            end each output line with NUL, not newline,\n";
 	cout << "                        and disable file name escaping\n";
-	cout << "  -l, --length          set checksum width (allowed values: 32 <= 32*n <= 1024)\n";
+	cout << "  -l, --length          set checksum width (allowed values: 32 <= 32*n <= 1024),\n";
+	cout << "                        a comma separated list computes several widths in a\n";
+	cout << "                        single pass, printing one line per width\n";
+	cout << "  -j, --jobs N          checksum N FILEs concurrently (0 means all cores)\n";
+	cout << "      --threads N       use N threads to checksum each FILE (0 means all cores),\n";
+	cout << "                        when checking, the listed files are divided over N threads\n";
+	cout << "      --bufsize SIZE    read standard input in buffers of SIZE bytes, the suffixes\n";
+	cout << "                        K, M, and G are allowed (default 1M)\n";
+	cout << "      --window SIZE     read FILEs larger than SIZE bytes one window at a time, the\n";
+	cout << "                        suffixes K, M, and G are allowed (default 64M, 0 = whole file)\n";
+	cout << "      --drop-cache      drop each window from the page cache after it was processed\n";
+	cout << "      --readahead SIZE  ask the kernel to start reading the first SIZE bytes of each\n";
+	cout << "                        FILE (or window) when it is mapped, the suffixes K, M, and G\n";
+	cout << "                        are allowed (default 16M, 0 = off)\n";
+	cout << "      --direct          read FILEs with O_DIRECT, bypassing the page cache, in\n";
+	cout << "                        buffers of SIZE bytes set by --bufsize\n";
+	cout << "      --io METHOD       read FILEs using METHOD: mmap (default) or uring\n";
+	cout << "      --iodepth N       keep N reads in flight with --io uring (default 8)\n";
+	cout << "      --seed LIST       use the seed (or comma separated list of seeds) in LIST,\n";
+	cout << "                        decimal or hexadecimal with 0x (default 0xfd4c799d), with\n";
+	cout << "                        several seeds one line per seed is printed\n";
+	cout << "      --checkpoint CKPT save the state of the calculation to CKPT at regular intervals\n";
+	cout << "                        and at the end, only a single FILE can be used\n";
+	cout << "      --resume          continue the calculation from the state saved in CKPT, the\n";
+	cout << "                        part of FILE that was already processed is not read again\n";
+	cout << "      --incremental     save the state for each FILE in FILE.vhstate, a later run\n";
+	cout << "                        only reads the data appended to FILE since then\n";
+	cout << "      --index CHUNK     also write the checksums of consecutive CHUNK byte pieces of\n";
+	cout << "                        each FILE to FILE.vhidx, the suffixes K, M, and G are allowed\n";
+	cout << "      --verify-range OFFSET:LEN\n";
+	cout << "                        verify LEN bytes of each FILE starting at OFFSET against\n";
+	cout << "                        FILE.vhidx, only the chunks overlapping the range are read\n";
+	cout << "      --diff-index      compare the two index files given as FILEs and print the\n";
+	cout << "                        ranges OFFSET:LEN in which the indexed files differ\n";
+	cout << "      --tree            compute tree-mode (VHT) checksums, these are suited for\n";
+	cout << "                        parallel processing but differ from normal checksums\n";
 	cout << "      --                this flag terminates the list of OPTIONs, allowing FILE\n";
 	cout << "                        names starting with \"-\" to be used after this flag\n"; 
 	cout << endl;
-	cout << "The following four options are mainly useful for testing:\n";
+	cout << "The following five options are mainly useful for testing:\n";
 	cout << "      --scalar          force using scalar version of algorithm\n";
 	cout << "      --sse2            force using SSE2 version of algorithm\n";
 	cout << "      --avx2            force using AVX2 version of algorithm\n";
 	cout << "      --avx512          force using AVX512f version of algorithm\n";
+	cout << "      --no-hugepages    do not use huge pages for the I/O buffers\n";
 	cout << endl;
 	cout << "The following five options are useful only when verifying checksums:\n";
 	cout << "  -i, --ignore-missing  don't fail or report status for missing files\n";
@@ -504,6 +2165,70 @@ static bool read_whole_line(string& chLine, FILE *io)
 	return ( chLine.length() > 0 );
 }
 
+// Call work(i) for i = 0..n-1 using up to nthreads threads, and report(i) in the
+// calling thread in strictly increasing order of i, as soon as work(i) is done.
+template<class W, class R>
+static void RunOrdered(size_t n, size_t nthreads, W work, R report)
+{
+	vector<thread> workers;
+	vector<char> done(n, 0);
+	atomic<size_t> next(0);
+	mutex mtx;
+	condition_variable cv;
+	auto worker = [&]() {
+		size_t i;
+		while( (i = next++) < n )
+		{
+			work(i);
+			lock_guard<mutex> lock(mtx);
+			done[i] = 1;
+			cv.notify_all();
+		}
+	};
+	for( size_t w=0; nthreads > 1 && w < min(nthreads, n); w++ )
+	{
+		try
+		{
+			workers.emplace_back( worker );
+		}
+		catch( const system_error& )
+		{
+			// we could not start a new thread, the remaining threads will do the work
+			break;
+		}
+	}
+	if( workers.empty() )
+	{
+		for( size_t i=0; i < n; i++ )
+		{
+			work(i);
+			report(i);
+		}
+		return;
+	}
+	for( size_t i=0; i < n; i++ )
+	{
+		unique_lock<mutex> lock(mtx);
+		cv.wait( lock, [&]() { return done[i] != 0; } );
+		lock.unlock();
+		report(i);
+	}
+	for( auto& w : workers )
+		w.join();
+}
+
+// a single line from the file with checksums
+struct check_entry {
+	size_t lineno;
+	bool lgFormatErr;
+	bool lgBinary;
+	bool lgOpenErr;
+	string path;
+	string vhsum1;
+	string vhsum2;
+	check_entry() : lineno(0), lgFormatErr(true), lgBinary(false), lgOpenErr(false) {}
+};
+
 static void CheckFiles(vh_params& vhp, const string& arg, FILE* io)
 {
 	string line;
@@ -512,9 +2237,12 @@ static void CheckFiles(vh_params& vhp, const string& arg, FILE* io)
 	size_t formaterr = 0;
 	size_t correct = 0;
 	size_t lineno= 0 ;
+	size_t hashlen = vhp.vh_hash_width/4;
 	// do not allow upper case hexadecimal digits as unmodified output should always be lower case
-	const regex bsd_format( "^(\\\\)?VH([[:d:]]+) \\(([^\\n]+)\\) = ([[:d:]a-f]+)$" );
+	const regex bsd_format( "^(\\\\)?VH(T?)([[:d:]]+) \\(([^\\n]+)\\) = ([[:d:]a-f]+)$" );
 	const regex std_format( "^(\\\\)?([[:d:]a-f]+) ([ *])([^\\n]+)$" );
+	// first parse the entire file, so that the files can be checked in parallel
+	vector<check_entry> entries;
 	while( read_whole_line(line, io) )
 	{
 		while( true )
@@ -527,141 +2255,432 @@ static void CheckFiles(vh_params& vhp, const string& arg, FILE* io)
 		}
 		++lineno;
 
+		entries.emplace_back();
+		check_entry& e = entries.back();
+		e.lineno = lineno;
 		bool lgEscape;
-		size_t hashlen = vhp.vh_hash_width/4;
-		string vhsum1, path;
 		smatch what;
 		if( regex_match( line, what, bsd_format ) )
 		{
 			lgEscape = what[1].matched;
+			bool lgTree = ( what[2] == "T" );
 			size_t my_width;
-			istringstream iss( what[2] );
+			istringstream iss( what[3] );
 			iss >> my_width;
-			path = what[3];
-			vhsum1 = what[4];
-			vhp.lgBinary = true;
-			if( my_width != vhp.vh_hash_width || vhsum1.length() != hashlen )
-			{
-				if( vhp.lgWarnSyntax )
-				{
-					cerr << vhp.cmd << ": " << escfn(arg) << ": " << lineno;
-					cerr << ": improperly formatted " << vhp.name << " checksum line\n";
-				}
-				++formaterr;
+			e.path = what[4];
+			e.vhsum1 = what[5];
+			e.lgBinary = true;
+			if( lgTree != vhp.lgTree || my_width != vhp.vh_hash_width || e.vhsum1.length() != hashlen )
 				continue;
-			}
-			++correct;
 		}
 		else if( regex_match( line, what, std_format ) )
 		{
 			lgEscape = what[1].matched;
-			vhsum1 = what[2];
-			vhp.lgBinary = ( what[3] == "*" );
-			path = what[4];
-			if( vhsum1.length() != hashlen )
-			{
-				if( vhp.lgWarnSyntax )
-				{
-					cerr << vhp.cmd << ": " << escfn(arg) << ": " << lineno;
-					cerr << ": improperly formatted " << vhp.name << " checksum line\n";
-				}
-				++formaterr;
+			e.vhsum1 = what[2];
+			e.lgBinary = ( what[3] == "*" );
+			e.path = what[4];
+			if( e.vhsum1.length() != hashlen )
 				continue;
-			}
-			++correct;
 		}
 		else
+			continue;
+		if( lgEscape )
+			e.path = DeEscape( e.path );
+		e.lgFormatErr = false;
+	}
+
+	// the files are divided over the jobs (or threads if --jobs was not used),
+	// so each file is checksummed single-threaded
+	size_t nworker = vh_params::ncores( ( vhp.njobs != 1 ) ? vhp.njobs : vhp.nthreads );
+	vh_params vhw = vhp;
+	if( nworker > 1 )
+		vhw.nthreads = 1;
+
+	auto work = [&]( size_t i ) {
+		check_entry& e = entries[i];
+		if( e.lgFormatErr )
+			return;
+		FILE* io = fopen( e.path.c_str(), ( e.lgBinary ? "rb" : "r" ) );
+		if( io == 0 )
+			e.lgOpenErr = true;
+		else
+		{
+			e.vhsum2 = VHstream( vhw, io );
+			fclose( io );
+		}
+	};
+
+	// release the memory of an entry once it is reported, the manifest may be very long
+	auto release = []( check_entry& e ) {
+		string().swap( e.path );
+		string().swap( e.vhsum1 );
+		string().swap( e.vhsum2 );
+	};
+
+	auto report = [&]( size_t i ) {
+		check_entry& e = entries[i];
+		if( e.lgFormatErr )
 		{
 			if( vhp.lgWarnSyntax )
 			{
-				cerr << vhp.cmd << ": " << escfn(arg) << ": " << lineno;
+				cerr << vhp.cmd << ": " << escfn(arg) << ": " << e.lineno;
 				cerr << ": improperly formatted " << vhp.name << " checksum line\n";
 			}
 			++formaterr;
-			continue;
+			release( e );
+			return;
 		}
-		if( lgEscape )
-			path = DeEscape( path );
+		++correct;
 		string esc;
-		if( path.find('\n') != string::npos )
-			esc = "\\" + Escape( path );
+		if( e.path.find('\n') != string::npos )
+			esc = "\\" + Escape( e.path );
 		else
-			esc = path;
-		FILE* io = fopen( path.c_str(), ( vhp.lgBinary ? "rb" : "r" ) );
-		string vhsum2;
-		if( io == 0 )
+			esc = e.path;
+		if( e.lgOpenErr )
 		{
 			if( !vhp.lgIgnoreMissing )
 			{
 				if( !vhp.lgStatusOnly )
-					cerr << vhp.cmd << ": " << escfn(path) << ": No such file or directory\n";
+					cerr << vhp.cmd << ": " << escfn(e.path) << ": No such file or directory\n";
 				vhp.returncode = 1;
 			}
 		}
-		else
+		if( e.vhsum2.length() == 0 && !vhp.lgIgnoreMissing )
+		{
+			if( !vhp.lgStatusOnly )
+				cout << esc << ": FAILED open or read\n";
+			vhp.returncode = 1;
+			++ioerror;
+		}
+		if( e.vhsum1 == e.vhsum2 )
+		{
+			if( !vhp.lgQuiet && !vhp.lgStatusOnly )
+				cout << esc << ": OK\n";
+		}
+		else if( e.vhsum2.length() == hashlen )
+		{
+			if( !vhp.lgStatusOnly )
+				cout << esc << ": FAILED\n";
+			vhp.returncode = 1;
+			++failed;
+		}
+		release( e );
+	};
+
+	RunOrdered( entries.size(), nworker, work, report );
+
+	if( !vhp.lgStatusOnly )
+	{
+		if( ioerror == 1 )
+			cerr << vhp.cmd << ": WARNING: 1 listed file could not be read\n";
+		else if( ioerror > 1 )
+			cerr << vhp.cmd << ": WARNING: " << ioerror << " listed files could not be read\n";
+		if( failed == 1 )
+			cerr << vhp.cmd << ": WARNING: 1 computed checksum did NOT match\n";
+		else if( failed > 1 )
+			cerr << vhp.cmd << ": WARNING: " << failed << " computed checksums did NOT match\n";
+		if( correct == 0 ) {
+			cerr << vhp.cmd << ": " << escfn(arg) << ": no properly formatted " << vhp.name << " checksum lines found\n";
+			vhp.returncode = 1;
+		}
+		else if( formaterr == 1 )
+			cerr << vhp.cmd << ": WARNING: 1 line is improperly formatted\n";
+		else if( formaterr > 1 )
+			cerr << vhp.cmd << ": WARNING: " << formaterr << " lines are improperly formatted\n";
+	}
+	if( vhp.lgStrict && formaterr > 0 )
+		vhp.returncode = 1;
+}
+
+inline void PrintVerbose(const vh_params& vhp)
+{
+	if( vhp.lgVerbose )
+	{
+		cout << "blocksize: " << vhp.blocksize << " bytes, ";
+		cout << "seed: 0x" << hex << setw(8) << setfill('0') << vhp.seed << endl;
+	}
+}
+
+static void ProcessFile(vh_params& vhp, const string& arg, FILE* io)
+{
+	PrintVerbose( vhp );
+	if( vhp.lgCheckMode )
+	{
+		CheckFiles( vhp, arg, ( io == 0 ? stdin : io ) );
+	}
+	else
+	{
+		string vhsum = ( io == 0 ) ? VHread( vhp, stdin ) : VHstream( vhp, io );
+		PrintSum( vhp, arg, vhsum );
+	}
+}
+
+static void ProcessCheckpoint(vh_params& vhp, const string& arg)
+{
+	FILE* io = ( arg == "-" ) ? 0 : fopen( arg.c_str(), vhp.option().c_str() );
+	if( arg != "-" && io == 0 )
+	{
+		cerr << vhp.cmd << ": " << escfn(arg) << ": No such file or directory\n";
+		vhp.returncode = 1;
+		return;
+	}
+	PrintVerbose( vhp );
+	string vhsum = VHcheckpoint( vhp, arg, io );
+	if( !vhsum.empty() )
+		PrintSum( vhp, arg, vhsum );
+	if( io != 0 )
+		fclose( io );
+}
+
+// checksum a FILE that gets a sidecar, this is done by VHincremental or VHindex
+static void ProcessSidecar(vh_params& vhp, const string& arg, const string& opt,
+						   string (*vhf)(vh_params&, const string&, FILE*))
+{
+	if( arg == "-" )
+	{
+		cerr << vhp.cmd << ": standard input cannot be checksummed with " << opt << "\n";
+		vhp.returncode = 1;
+		return;
+	}
+	FILE* io = fopen( arg.c_str(), vhp.option().c_str() );
+	if( io == 0 )
+	{
+		cerr << vhp.cmd << ": " << escfn(arg) << ": No such file or directory\n";
+		vhp.returncode = 1;
+		return;
+	}
+	PrintVerbose( vhp );
+	string vhsum = vhf( vhp, arg, io );
+	if( !vhsum.empty() )
+		PrintSum( vhp, arg, vhsum );
+	fclose( io );
+}
+
+// checksum the files using vhp.njobs jobs, the output is identical to processing them one by one
+static void ProcessFilesParallel(vh_params& vhp, const vector<string>& fnam)
+{
+	struct file_result {
+		bool lgOpenErr;
+		string vhsum;
+		file_result() : lgOpenErr(false) {}
+	};
+	vector<file_result> res(fnam.size());
+
+	// the files are divided over the jobs, so each file is checksummed single-threaded
+	size_t nworker = vh_params::ncores(vhp.njobs);
+	vh_params vhw = vhp;
+	if( nworker > 1 )
+		vhw.nthreads = 1;
+
+	auto work = [&]( size_t i ) {
+		// stdin can only be read in order, so this is done while reporting
+		if( fnam[i] == "-" )
+			return;
+		FILE* io = fopen( fnam[i].c_str(), vhp.option().c_str() );
+		if( io == 0 )
+			res[i].lgOpenErr = true;
+		else
+		{
+			res[i].vhsum = VHstream( vhw, io );
+			fclose( io );
+		}
+	};
+
+	auto report = [&]( size_t i ) {
+		if( fnam[i] == "-" )
+			ProcessFile( vhp, fnam[i], 0 );
+		else if( res[i].lgOpenErr )
+		{
+			cerr << vhp.cmd << ": " << escfn(fnam[i]) << ": No such file or directory\n";
+			vhp.returncode = 1;
+		}
+		else
+		{
+			PrintVerbose( vhp );
+			PrintSum( vhp, fnam[i], res[i].vhsum );
+		}
+		string().swap( res[i].vhsum );
+	};
+
+	RunOrdered( fnam.size(), nworker, work, report );
+}
+
+// checksum the files for all widths and seeds, one line is printed per width and seed
+static void ProcessFilesMulti(vh_params& vhp, const vector<string>& fnam)
+{
+	struct file_result {
+		bool lgOpenErr;
+		vector<string> vhsum;
+		file_result() : lgOpenErr(false) {}
+	};
+	vector<file_result> res(fnam.size());
+
+	// the files are divided over the jobs, so each file is checksummed single-threaded
+	size_t nworker = vh_params::ncores(vhp.njobs);
+	vh_params vhw = vhp;
+	if( nworker > 1 )
+		vhw.nthreads = 1;
+
+	auto work = [&]( size_t i ) {
+		// stdin can only be read in order, so this is done while reporting
+		if( fnam[i] == "-" )
+			return;
+		FILE* io = fopen( fnam[i].c_str(), vhp.option().c_str() );
+		if( io == 0 )
+			res[i].lgOpenErr = true;
+		else
+		{
+			res[i].vhsum = VHmulti( vhw, io );
+			fclose( io );
+		}
+	};
+
+	auto report = [&]( size_t i ) {
+		if( fnam[i] == "-" )
+			res[i].vhsum = VHmulti( vhp, 0 );
+		if( res[i].lgOpenErr )
+		{
+			cerr << vhp.cmd << ": " << escfn(fnam[i]) << ": No such file or directory\n";
+			vhp.returncode = 1;
+			return;
+		}
+		PrintVerbose( vhp );
+		// each line gets the name of its own width with --tag
+		vh_params vhw( vhp );
+		size_t k = 0;
+		for( auto hw : vhp.all_widths() )
+		{
+			vhw.set_hash_width( hw );
+			for( size_t j=0; j < vhp.all_seeds().size(); ++j, ++k )
+				PrintSum( vhw, fnam[i], res[i].vhsum.empty() ? string() : res[i].vhsum[k] );
+		}
+		vector<string>().swap( res[i].vhsum );
+	};
+
+	RunOrdered( fnam.size(), nworker, work, report );
+}
+
+// files up to this size (in bytes) are read completely and checksummed together with
+// VectorHashBatch, which advances several of them in lockstep
+static const size_t vh_batch_max = size_t(256) << 10;
+// the largest number of files in a single batch
+static const size_t vh_batch_files = 64;
+
+// checksum the files one by one in order, but collect consecutive small files into batches
+static void ProcessFilesBatch(vh_params& vhp, const vector<string>& fnam)
+{
+	struct small_file {
+		const string* name;
+		size_t off;
+		size_t len;
+		bool lgOK;
+	};
+	vector<small_file> pend;
+	vector<char> data;
+
+	auto flush = [&]() {
+		if( pend.empty() )
+			return;
+		vector<const void*> bufs(pend.size());
+		vector<size_t> lens(pend.size());
+		for( size_t i=0; i < pend.size(); i++ )
 		{
-			vhsum2 = VHstream( vhp, io );
-			fclose( io );
+			bufs[i] = data.data() + pend[i].off;
+			lens[i] = pend[i].len;
 		}
-		if( vhsum2.length() == 0 && !vhp.lgIgnoreMissing )
+		vector<uint32_t> res(pend.size()*vhp.vh_nhash);
+		VectorHashBatch( bufs.data(), lens.data(), pend.size(), vhp.seed, res.data(), vhp.SIMDversion,
+						 vhp.vh_hash_width );
+		for( size_t i=0; i < pend.size(); i++ )
 		{
-			if( !vhp.lgStatusOnly )
-				cout << esc << ": FAILED open or read\n";
-			vhp.returncode = 1;
-			++ioerror;
+			ostringstream hash;
+			if( pend[i].lgOK )
+				for( size_t j=0; j < vhp.vh_nhash; ++j )
+					hash << hex << setfill('0') << setw(8) << res[i*vhp.vh_nhash+j];
+			PrintVerbose( vhp );
+			PrintSum( vhp, *pend[i].name, hash.str() );
 		}
-		if( vhsum1 == vhsum2 )
+		pend.clear();
+		data.clear();
+	};
+
+	for( const auto& file : fnam )
+	{
+		if( file == "-" )
 		{
-			if( !vhp.lgQuiet && !vhp.lgStatusOnly )
-				cout << esc << ": OK\n";
+			flush();
+			ProcessFile( vhp, file, 0 );
+			continue;
 		}
-		else if( vhsum2.length() == hashlen )
+		FILE* io = fopen( file.c_str(), vhp.option().c_str() );
+		if( io == 0 )
 		{
-			if( !vhp.lgStatusOnly )
-				cout << esc << ": FAILED\n";
+			flush();
+			cerr << vhp.cmd << ": " << escfn(file) << ": No such file or directory\n";
 			vhp.returncode = 1;
-			++failed;
+			continue;
 		}
-	}
-	if( !vhp.lgStatusOnly )
-	{
-		if( ioerror == 1 )
-			cerr << vhp.cmd << ": WARNING: 1 listed file could not be read\n";
-		else if( ioerror > 1 )
-			cerr << vhp.cmd << ": WARNING: " << ioerror << " listed files could not be read\n";
-		if( failed == 1 )
-			cerr << vhp.cmd << ": WARNING: 1 computed checksum did NOT match\n";
-		else if( failed > 1 )
-			cerr << vhp.cmd << ": WARNING: " << failed << " computed checksums did NOT match\n";
-		if( correct == 0 ) {
-			cerr << vhp.cmd << ": " << escfn(arg) << ": no properly formatted " << vhp.name << " checksum lines found\n";
-			vhp.returncode = 1;
+#if _POSIX_MAPPED_FILES > 0
+		off_t fsize = ( fseeko( io, 0, SEEK_END ) == 0 ) ? ftello(io) : -1;
+#else
+		long fsize = ( fseek( io, 0, SEEK_END ) == 0 ) ? ftell(io) : -1;
+#endif
+		if( fsize < 0 || uint64_t(fsize) > vh_batch_max || !IsMappable( io ) || fseek( io, 0, SEEK_SET ) != 0 )
+		{
+			// this also handles pipes, devices, and files that do not report their size
+			flush();
+			ProcessFile( vhp, file, io );
+			fclose( io );
+			continue;
 		}
-		else if( formaterr == 1 )
-			cerr << vhp.cmd << ": WARNING: 1 line is improperly formatted\n";
-		else if( formaterr > 1 )
-			cerr << vhp.cmd << ": WARNING: " << formaterr << " lines are improperly formatted\n";
+		small_file sf;
+		sf.name = &file;
+		sf.off = data.size();
+		sf.len = size_t(fsize);
+		data.resize( sf.off + sf.len );
+		sf.lgOK = ( sf.len == 0 || fread( &data[sf.off], sf.len, 1, io ) == 1 );
+		fclose( io );
+		pend.push_back( sf );
+		if( pend.size() == vh_batch_files || data.size() >= vhp.bufsize )
+			flush();
 	}
-	if( vhp.lgStrict && formaterr > 0 )
-		vhp.returncode = 1;
+	flush();
 }
 
-static void ProcessFile(vh_params& vhp, const string& arg, FILE* io)
+// checksum the files using a single io_uring, returns false if that is not possible
+static bool ProcessFilesUring(vh_params& vhp, const vector<string>& fnam)
 {
+#ifdef VH_HAVE_URING
+	vector<char> lgMissing(fnam.size(), 0);
+	auto openf = [&]( size_t i ) {
+		int fd = open( fnam[i].c_str(), O_RDONLY );
+		if( fd < 0 )
+			lgMissing[i] = 1;
+		return fd;
+	};
+	auto closef = []( size_t, int fd ) {
+		close( fd );
+	};
+	auto report = [&]( size_t i, const string& vhsum ) {
+		if( lgMissing[i] )
+		{
+			cerr << vhp.cmd << ": " << escfn(fnam[i]) << ": No such file or directory\n";
+			vhp.returncode = 1;
+		}
+		else
+		{
+			PrintVerbose( vhp );
+			PrintSum( vhp, fnam[i], vhsum );
+		}
+	};
+	if( UringFiles( vhp, fnam.size(), openf, closef, report, true ) )
+		return true;
+#else
+	(void)fnam;
+#endif
 	if( vhp.lgVerbose )
-	{
-		cout << "blocksize: " << vhp.blocksize << " bytes, ";
-		cout << "seed: 0x" << hex << setw(8) << setfill('0') << vhp.seed << endl;
-	}
-	if( vhp.lgCheckMode )
-	{
-		CheckFiles( vhp, arg, ( io == 0 ? stdin : io ) );
-	}
-	else
-	{
-		string vhsum = ( io == 0 ) ? VHstdin( vhp ) : VHstream( vhp, io );
-		PrintSum( vhp, arg, vhsum );
-	}
+		cout << "io_uring is not available, falling back to mmap" << endl;
+	return false;
 }
 
 static void VerifyOptions( vh_params& vhp )
@@ -673,6 +2692,10 @@ static void VerifyOptions( vh_params& vhp )
 	else
 		vhp.lgBinary = O_BINARY;
 
+	// tree mode checksums get a different name so that they cannot be confused
+	if( vhp.lgTree )
+		vhp.set_hash_width( vhp.vh_hash_width );
+
 	vhp.SetSIMDVersion();
 
 	if( vhp.lgIgnoreMissing && !vhp.lgCheckMode )
@@ -681,13 +2704,13 @@ static void VerifyOptions( vh_params& vhp )
 		cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
 		exit(1);
 	}
-	if( vhp.lgStatusOnly && !vhp.lgCheckMode )
+	if( vhp.lgStatusOnly && !vhp.lgCheckMode && !vhp.lgVerifyRange && !vhp.lgDiffIndex )
 	{
 		cerr << vhp.cmd << ": the --status option is meaningful only when verifying checksums\n";
 		cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
 		exit(1);
 	}
-	if( vhp.lgQuiet && !vhp.lgCheckMode )
+	if( vhp.lgQuiet && !vhp.lgCheckMode && !vhp.lgVerifyRange )
 	{
 		cerr << vhp.cmd << ": the --quiet option is meaningful only when verifying checksums\n";
 		cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
@@ -729,6 +2752,59 @@ static void VerifyOptions( vh_params& vhp )
 		cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
 		exit(1);
 	}
+	if( vhp.seeds.size() > 1 && vhp.lgCheckMode )
+	{
+		cerr << vhp.cmd << ": only a single seed can be used when verifying checksums\n";
+		cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
+		exit(1);
+	}
+	if( vhp.seeds.size() > 1 && vhp.lgTree )
+	{
+		cerr << vhp.cmd << ": only a single seed can be used with --tree\n";
+		cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
+		exit(1);
+	}
+	if( vhp.widths.size() > 1 && vhp.lgCheckMode )
+	{
+		cerr << vhp.cmd << ": only a single length can be used when verifying checksums\n";
+		cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
+		exit(1);
+	}
+	if( vhp.widths.size() > 1 && vhp.lgTree )
+	{
+		cerr << vhp.cmd << ": only a single length can be used with --tree\n";
+		cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
+		exit(1);
+	}
+	if( vhp.lgResume && vhp.checkpoint.empty() )
+	{
+		cerr << vhp.cmd << ": the --resume option requires --checkpoint\n";
+		cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
+		exit(1);
+	}
+	if( !vhp.checkpoint.empty() && ( vhp.lgCheckMode || vhp.lgTree || vhp.multi() ) )
+	{
+		cerr << vhp.cmd << ": the --checkpoint option cannot be combined with --check, --tree, or several "
+			"lengths or seeds\n";
+		cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
+		exit(1);
+	}
+	if( vhp.lgIncremental && ( vhp.lgCheckMode || vhp.lgTree || vhp.multi() || !vhp.checkpoint.empty() ) )
+	{
+		cerr << vhp.cmd << ": the --incremental option cannot be combined with --check, --tree, --checkpoint, "
+			"or several lengths or seeds\n";
+		cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
+		exit(1);
+	}
+	int nmode = int(vhp.indexchunk > 0) + int(vhp.lgVerifyRange) + int(vhp.lgDiffIndex);
+	if( nmode > 1 || ( nmode > 0 && ( vhp.lgCheckMode || vhp.lgTree || vhp.multi() || !vhp.checkpoint.empty() ||
+									  vhp.lgIncremental ) ) )
+	{
+		cerr << vhp.cmd << ": the --index, --verify-range, and --diff-index options cannot be combined with each "
+			"other, --check, --tree, --checkpoint, --incremental, or several lengths or seeds\n";
+		cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
+		exit(1);
+	}
 	if( vhp.lgStatusOnly && vhp.lgVerbose )
 	{
 		cerr << vhp.cmd << ": the --verbose option conflicts with --status\n";
@@ -821,13 +2897,85 @@ bool MatchLongParm(const string lopt[], const size_t loml[], size_t nlopt, strin
 	return false;
 }
 
-string GetParameter(char** argv, int& i, int j, uint32_t& res)
+// parse a size with an optional suffix K, M, or G
+static bool ParseSize(const string& num, uint64_t& val)
 {
-	string num;
-	if( j < 0 || int(strlen(argv[i])) == j+1 )
-		num = argv[++i];
-	else
-		num = argv[i]+j+1;
+	// the stream would silently accept negative numbers
+	if( num.empty() || !isdigit(num[0]) )
+		return false;
+	istringstream iss(num);
+	iss >> val;
+	if( iss.fail() )
+		return false;
+	char suffix;
+	if( iss >> suffix )
+	{
+		int shift;
+		if( suffix == 'K' )
+			shift = 10;
+		else if( suffix == 'M' )
+			shift = 20;
+		else if( suffix == 'G' )
+			shift = 30;
+		else
+			return false;
+		if( iss.peek() != EOF || val > (UINT64_MAX >> shift) )
+			return false;
+		val <<= shift;
+	}
+	return true;
+}
+
+// return the argument of the option argv[i], which is either the next word on the command line, or
+// the rest of argv[i] after the short option at position j (j < 0 for a long option)
+static string GetArgument(const vh_params& vhp, int argc, char** argv, int& i, int j)
+{
+	if( j >= 0 && int(strlen(argv[i])) > j+1 )
+		return argv[i]+j+1;
+	if( i+1 >= argc )
+	{
+		if( j < 0 )
+			cerr << vhp.cmd << ": option '" << argv[i] << "' requires an argument\n";
+		else
+			cerr << vhp.cmd << ": option requires an argument -- '" << argv[i][j] << "'\n";
+		cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
+		exit(1);
+	}
+	return argv[++i];
+}
+
+// read a size in bytes, optionally followed by the suffix K, M, or G
+string GetSize(const vh_params& vhp, int argc, char** argv, int& i, int j, size_t& res)
+{
+	string num = GetArgument(vhp, argc, argv, i, j);
+	uint64_t val;
+	if( !ParseSize(num, val) )
+		return num;
+	res = size_t(val);
+	if( uint64_t(res) != val )
+		return num;
+	return string();
+}
+
+// read the range OFFSET:LEN for --verify-range
+static bool GetRange(vh_params& vhp, char** argv, int& i)
+{
+	string range = ( argv[i+1] != 0 ) ? argv[++i] : "";
+	size_t p = range.find(':');
+	if( p == string::npos || !ParseSize(range.substr(0, p), vhp.range_off) ||
+		!ParseSize(range.substr(p+1), vhp.range_len) )
+	{
+		cerr << vhp.cmd << ": invalid range: '" << range << "'\n";
+		cerr << vhp.cmd << ": the range should be given as OFFSET:LEN\n";
+		return false;
+	}
+	vhp.lgVerifyRange = true;
+	return true;
+}
+
+string GetParameter(const vh_params& vhp, int argc, char** argv, int& i, int j, uint32_t& res)
+{
+	string num = GetArgument(vhp, argc, argv, i, j);
 	istringstream iss(num);
 	iss >> res;
 	if( iss.fail() || !iss.eof() )
@@ -836,6 +2984,80 @@ string GetParameter(char** argv, int& i, int j, uint32_t& res)
 		return string();
 }
 
+// read a comma separated list of checksum widths, and select the first one
+static bool GetLengths(vh_params& vhp, int argc, char** argv, int& i, int j)
+{
+	string list = GetArgument(vhp, argc, argv, i, j);
+	vector<size_t> widths;
+	istringstream iss(list);
+	string item;
+	while( getline( iss, item, ',' ) )
+	{
+		istringstream is(item);
+		uint32_t hw;
+		is >> hw;
+		if( item.empty() || is.fail() || !is.eof() )
+		{
+			cerr << vhp.cmd << ": invalid length: '" << item << "'\n";
+			return false;
+		}
+		if( !vhp.set_hash_width(hw) )
+		{
+			cerr << vhp.cmd << ": invalid length: '" << hw << "'\n";
+			cerr << vhp.cmd << ": length must be a multiple of 32 between 32 and 1024\n";
+			return false;
+		}
+		widths.push_back(hw);
+	}
+	if( widths.empty() || list.back() == ',' )
+	{
+		cerr << vhp.cmd << ": invalid length: '" << list << "'\n";
+		return false;
+	}
+	vhp.set_hash_width( widths[0] );
+	if( widths.size() > 1 )
+		vhp.widths = widths;
+	else
+		vhp.widths.clear();
+	return true;
+}
+
+// read a comma separated list of seeds, each given as a decimal number or as a hexadecimal number
+// starting with 0x, the first one is used when only a single checksum is calculated
+static bool GetSeeds(vh_params& vhp, int argc, char** argv, int& i)
+{
+	string list = GetArgument(vhp, argc, argv, i, -1);
+	vector<uint32_t> seeds;
+	istringstream iss(list);
+	string item;
+	while( getline( iss, item, ',' ) )
+	{
+		bool lgHex = ( item.compare(0, 2, "0x") == 0 || item.compare(0, 2, "0X") == 0 );
+		string num = lgHex ? item.substr(2) : item;
+		istringstream is(num);
+		uint32_t seed;
+		is >> ( lgHex ? hex : dec ) >> seed;
+		// the stream would silently accept negative numbers
+		if( num.empty() || !isxdigit(num[0]) || is.fail() || !is.eof() )
+		{
+			cerr << vhp.cmd << ": invalid seed: '" << item << "'\n";
+			return false;
+		}
+		seeds.push_back(seed);
+	}
+	if( seeds.empty() || list.back() == ',' )
+	{
+		cerr << vhp.cmd << ": invalid seed: '" << list << "'\n";
+		return false;
+	}
+	vhp.seed = seeds[0];
+	if( seeds.size() > 1 )
+		vhp.seeds = seeds;
+	else
+		vhp.seeds.clear();
+	return true;
+}
+
 int main(int argc, char** argv)
 {
 	vh_params vhp;
@@ -862,9 +3084,12 @@ int main(int argc, char** argv)
 
 	// the alphabetical list of recognized long options 
 	static const string lopt[] = {
-		"--avx2", "--avx512", "--binary", "--check", "--help", "--ignore-missing", "--length",
-		"--quiet", "--scalar", "--sse2", "--status", "--strict", "--tag", "--text", "--verbose",
-		"--version", "--warn", "--zero"
+		"--avx2", "--avx512", "--binary", "--bufsize", "--check", "--checkpoint", "--diff-index",
+		"--direct", "--drop-cache", "--help", "--ignore-missing", "--incremental", "--index",
+		"--io", "--iodepth", "--jobs", "--length", "--no-hugepages", "--quiet", "--readahead",
+		"--resume", "--scalar", "--seed", "--sse2", "--status", "--strict", "--tag", "--text",
+		"--threads", "--tree", "--verbose", "--verify-range", "--version", "--warn", "--window",
+		"--zero"
 	};
 	static const size_t nlopt = sizeof(lopt)/sizeof(string);
 	size_t loml[nlopt];
@@ -882,6 +3107,14 @@ int main(int argc, char** argv)
 	for( int i=1; i < argc; ++i )
 	{
 		string arg = argv[i];
+		// allow the form --io=METHOD as well
+		string ioarg;
+		bool lgIoarg = ( lgOptions && arg.compare(0, 5, "--io=") == 0 );
+		if( lgIoarg )
+		{
+			ioarg = arg.substr(5);
+			arg = "--io";
+		}
 		if( !lgOptions || arg.length() <= 1 || arg[0] != '-' )
 		{
 			fnam.emplace_back(arg);
@@ -915,19 +3148,20 @@ int main(int argc, char** argv)
 						vhp.lgIgnoreMissing = true;
 					else if( arg[j] == 'l' )
 					{
-						uint32_t hw;
-						auto s = GetParameter(argv, i, j, hw);
-						if( s != string() )
-						{
-							cerr << vhp.cmd << ": invalid length: '" << s << "'\n";
+						if( !GetLengths(vhp, argc, argv, i, j) )
 							return 1;
-						}
-						if( !vhp.set_hash_width(hw) )
+						j = arg.length();
+					}
+					else if( arg[j] == 'j' )
+					{
+						uint32_t njobs;
+						auto s = GetParameter(vhp, argc, argv, i, j, njobs);
+						if( s != string() )
 						{
-							cerr << vhp.cmd << ": invalid length: '" << hw << "'\n";
-							cerr << vhp.cmd << ": length must be a multiple of 32 between 32 and 1024\n";
+							cerr << vhp.cmd << ": invalid number of jobs: '" << s << "'\n";
 							return 1;
 						}
+						vhp.njobs = njobs;
 						j = arg.length();
 					}
 					else if( arg[j] == 'q' )
@@ -966,32 +3200,111 @@ int main(int argc, char** argv)
 				vhp.lgBinarySet = true;
 				vhp.lgTextSet = false;
 			}
+			else if( arg == "--bufsize" )
+			{
+				auto s = GetSize(vhp, argc, argv, i, -1, vhp.bufsize);
+				if( s != string() || vhp.bufsize == 0 )
+				{
+					cerr << vhp.cmd << ": invalid buffer size: '" << argv[i] << "'\n";
+					return 1;
+				}
+			}
 			else if( arg == "--check" )
 				vhp.lgCheckMode = true;
+			else if( arg == "--checkpoint" )
+			{
+				if( i+1 >= argc )
+				{
+					cerr << vhp.cmd << ": option '--checkpoint' requires an argument\n";
+					cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
+					return 1;
+				}
+				vhp.checkpoint = argv[++i];
+			}
+			else if( arg == "--diff-index" )
+				vhp.lgDiffIndex = true;
+			else if( arg == "--direct" )
+				vhp.lgDirect = true;
+			else if( arg == "--drop-cache" )
+				vhp.lgDropCache = true;
 			else if( arg == "--help" )
 				PrintHelp(vhp);
 			else if( arg == "--ignore-missing" )
 				vhp.lgIgnoreMissing = true;
-			else if( arg == "--length" )
+			else if( arg == "--incremental" )
+				vhp.lgIncremental = true;
+			else if( arg == "--index" )
 			{
-				uint32_t hw;
-				auto s = GetParameter(argv, i, -1, hw);
-				if( s != string() )
+				auto s = GetSize(vhp, argc, argv, i, -1, vhp.indexchunk);
+				if( s != string() || vhp.indexchunk == 0 )
+				{
+					cerr << vhp.cmd << ": invalid chunk size: '" << argv[i] << "'\n";
+					return 1;
+				}
+			}
+			else if( arg == "--io" )
+			{
+				string mode = lgIoarg ? ioarg : ( i+1 < argc ) ? argv[++i] : "";
+				if( mode == "uring" )
+					vhp.lgUring = true;
+				else if( mode == "mmap" )
+					vhp.lgUring = false;
+				else
+				{
+					cerr << vhp.cmd << ": invalid I/O method: '" << mode << "'\n";
+					cerr << vhp.cmd << ": valid methods are 'mmap' and 'uring'\n";
+					return 1;
+				}
+			}
+			else if( arg == "--iodepth" )
+			{
+				uint32_t depth;
+				auto s = GetParameter(vhp, argc, argv, i, -1, depth);
+				if( s != string() || depth < 1 || depth > 4096 )
 				{
-					cerr << vhp.cmd << ": invalid length: '" << s << "'\n";
+					cerr << vhp.cmd << ": invalid I/O queue depth: '" << argv[i] << "'\n";
 					return 1;
 				}
-				if( !vhp.set_hash_width(hw) )
+				vhp.iodepth = depth;
+			}
+			else if( arg == "--jobs" )
+			{
+				uint32_t njobs;
+				auto s = GetParameter(vhp, argc, argv, i, -1, njobs);
+				if( s != string() )
 				{
-					cerr << vhp.cmd << ": invalid length: '" << hw << "'\n";
-					cerr << vhp.cmd << ": length must be a multiple of 32 between 32 and 1024\n";
+					cerr << vhp.cmd << ": invalid number of jobs: '" << s << "'\n";
 					return 1;
 				}
+				vhp.njobs = njobs;
+			}
+			else if( arg == "--length" )
+			{
+				if( !GetLengths(vhp, argc, argv, i, -1) )
+					return 1;
 			}
+			else if( arg == "--no-hugepages" )
+				vhp.lgHugePages = false;
 			else if( arg == "--quiet" )
 				vhp.lgQuiet = true;
+			else if( arg == "--readahead" )
+			{
+				auto s = GetSize(vhp, argc, argv, i, -1, vhp.readahead);
+				if( s != string() )
+				{
+					cerr << vhp.cmd << ": invalid readahead size: '" << argv[i] << "'\n";
+					return 1;
+				}
+			}
+			else if( arg == "--resume" )
+				vhp.lgResume = true;
 			else if( arg == "--scalar" )
 				vhp.SIMDversion = IS_SCALAR;
+			else if( arg == "--seed" )
+			{
+				if( !GetSeeds(vhp, argc, argv, i) )
+					return 1;
+			}
 			else if( arg == "--sse2" )
 				vhp.SIMDversion = IS_SSE2;
 			else if( arg == "--status" )
@@ -1005,12 +3318,41 @@ int main(int argc, char** argv)
 				vhp.lgTextSet = true;
 				vhp.lgBinarySet = false;
 			}
+			else if( arg == "--threads" )
+			{
+				uint32_t nthreads;
+				auto s = GetParameter(vhp, argc, argv, i, -1, nthreads);
+				if( s != string() )
+				{
+					cerr << vhp.cmd << ": invalid number of threads: '" << s << "'\n";
+					return 1;
+				}
+				vhp.nthreads = nthreads;
+			}
+			else if( arg == "--tree" )
+				vhp.lgTree = true;
 			else if( arg == "--verbose" )
 				vhp.lgVerbose = true;
+			else if( arg == "--verify-range" )
+			{
+				if( !GetRange(vhp, argv, i) )
+					return 1;
+			}
 			else if( arg == "--version" )
 				PrintVersion(vhp);
 			else if( arg == "--warn" )
 				vhp.lgWarnSyntax = true;
+			else if( arg == "--window" )
+			{
+				auto s = GetSize(vhp, argc, argv, i, -1, vhp.window);
+				if( s != string() )
+				{
+					cerr << vhp.cmd << ": invalid window size: '" << argv[i] << "'\n";
+					return 1;
+				}
+				// round up to a multiple of the tree chunk size, this is also a multiple of the page size
+				vhp.window = (vhp.window + VH_TREE_CHUNKSIZE - 1)/VH_TREE_CHUNKSIZE*VH_TREE_CHUNKSIZE;
+			}
 			else if( arg == "--zero" )
 				vhp.lgZero = true;
 			else
@@ -1024,11 +3366,68 @@ int main(int argc, char** argv)
 
 	VerifyOptions( vhp );
 
-	if( fnam.size() == 0 )
+	if( !vhp.checkpoint.empty() )
+	{
+		if( fnam.size() > 1 )
+		{
+			cerr << vhp.cmd << ": only a single FILE can be used with --checkpoint\n";
+			cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
+			return 1;
+		}
+		ProcessCheckpoint( vhp, fnam.empty() ? "-" : fnam[0] );
+	}
+	else if( vhp.lgIncremental || vhp.indexchunk > 0 )
+	{
+		string opt = vhp.lgIncremental ? "--incremental" : "--index";
+		auto vhf = vhp.lgIncremental ? VHincremental : VHindex;
+		if( fnam.empty() )
+			ProcessSidecar( vhp, "-", opt, vhf );
+		for( const auto& file : fnam )
+			ProcessSidecar( vhp, file, opt, vhf );
+	}
+	else if( vhp.lgVerifyRange )
+	{
+		if( fnam.empty() )
+		{
+			cerr << vhp.cmd << ": --verify-range requires a FILE\n";
+			return 1;
+		}
+		for( const auto& file : fnam )
+			VerifyRange( vhp, file );
+	}
+	else if( vhp.lgDiffIndex )
+	{
+		if( fnam.size() != 2 )
+		{
+			cerr << vhp.cmd << ": --diff-index requires two index files\n";
+			cerr << "Try '" << vhp.cmd << " --help' for more information.\n";
+			return 2;
+		}
+		DiffIndex( vhp, fnam[0], fnam[1] );
+	}
+	else if( vhp.multi() )
+	{
+		// no file name means stdin
+		ProcessFilesMulti( vhp, fnam.empty() ? vector<string>(1, "-") : fnam );
+	}
+	else if( fnam.size() == 0 )
 	{
 		// no file name was given -> process stdin
 		ProcessFile( vhp, "-", 0 );
 	}
+	else if( !vhp.lgCheckMode && vhp.njobs != 1 )
+	{
+		ProcessFilesParallel( vhp, fnam );
+	}
+	else if( !vhp.lgCheckMode && vhp.lgUring && !vhp.lgDirect &&
+			 find( fnam.begin(), fnam.end(), "-" ) == fnam.end() && ProcessFilesUring( vhp, fnam ) )
+	{
+		// all done
+	}
+	else if( !vhp.lgCheckMode && !vhp.lgTree && !vhp.lgDirect )
+	{
+		ProcessFilesBatch( vhp, fnam );
+	}
 	else
 	{
 		for( const auto& file : fnam )
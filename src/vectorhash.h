@@ -10,13 +10,84 @@
 #ifndef VECTORHASH_H
 #define VECTORHASH_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// the state of an incremental checksum calculation, the contents should be treated as opaque
+// the sizes of the arrays are set by the widest supported checksum (1024 bits)
+typedef struct vh_state {
+	uint32_t h[4][64];     // the 4 state vectors h1..h4
+	uint8_t tail[1024];    // bytes that do not yet fill a complete block
+	uint64_t len;          // total number of bytes passed to VectorHashUpdate so far
+	uint32_t hash_width;   // width of the checksum in bits
+	uint32_t ntail;        // number of valid bytes in tail
+	int32_t simd;          // SIMD instruction set that will be used
+	uint32_t seed;         // seed passed to VectorHashInit
+} vh_state;
+
+// a buffer of this size can always hold the result of VectorHashStateSave
+#define VH_STATE_SAVE_MAX 2080
+
+#ifndef _MSC_VER
+// see <sys/uio.h>
+struct iovec;
+#endif
+
+// a routine that calculates the checksum of a buffer, see VectorHashGetImpl
+typedef void (*vh_impl)(const void* buf, size_t len, uint32_t seed, void* out, size_t hash_width);
+
 void VectorHash(const void* buf, size_t len, uint32_t seed, void* out, size_t hash_width);
+vh_impl VectorHashGetImpl(size_t hash_width);
+void VectorHashParallel(const void* buf, size_t len, uint32_t seed, void* out, size_t hash_width,
+						size_t nthreads);
+
+// default chunk size for the tree mode
+#define VH_TREE_CHUNKSIZE 1048576
+
+void VectorHashTree(const void* buf, size_t len, uint32_t seed, void* out, size_t hash_width, size_t chunksize,
+					size_t nthreads);
+size_t VectorHashTreeLeaves(size_t len, size_t chunksize);
+void VectorHashTreeHashLeaves(const void* buf, size_t len, uint32_t seed, void* leaves, size_t hash_width,
+							  size_t chunksize, size_t nthreads);
+// nleaves must be at least 1 (the value returned by VectorHashTreeLeaves), otherwise out is not written
+void VectorHashTreeRoot(const void* leaves, size_t nleaves, uint64_t len, uint32_t seed, void* out,
+						size_t hash_width, size_t chunksize);
+
+// checksums of n independent buffers, the results are stored back to back in outs (hash_width/8 bytes each)
+void VectorHashBatch(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed, void* outs,
+					 size_t hash_width);
+
+#ifndef _MSC_VER
+// checksum of the concatenation of iovcnt segments, the result is identical to VectorHash
+void VectorHashV(const struct iovec* iov, int iovcnt, uint32_t seed, void* out, size_t hash_width);
+#endif
+
+// software prefetching is used for large buffers, the distance (in bytes) can be tuned, 0 disables it
+void VectorHashSetPrefetch(size_t distance);
+size_t VectorHashGetPrefetch(void);
+
+void VectorHashInit(vh_state* state, uint32_t seed, size_t hash_width);
+void VectorHashUpdate(vh_state* state, const void* buf, size_t len);
+void VectorHashFinal(const vh_state* state, void* out);
+
+// store the state in a stable, versioned, and platform independent format, so that a long calculation can be
+// resumed later, possibly on another machine, returns the number of bytes stored or 0 if size is too small
+size_t VectorHashStateSave(const vh_state* state, void* buf, size_t size);
+// restore a state stored by VectorHashStateSave, returns 0 on success or -1 if buf does not hold a valid state
+int VectorHashStateLoad(vh_state* state, const void* buf, size_t size);
+
+// checksums of several widths over the same data in a single pass, the results are stored back to back
+// in outs (hash_widths[i]/8 bytes each), the states in the second form may have different widths
+void VectorHashMulti(const void* buf, size_t len, uint32_t seed, void* outs, const size_t hash_widths[], size_t n);
+void VectorHashUpdateMulti(vh_state* const states[], size_t n, const void* buf, size_t len);
+
+// checksums of the same data with n different seeds, the results are stored back to back in outs
+void VectorHashMultiSeed(const void* buf, size_t len, const uint32_t seeds[], size_t n, void* outs,
+						 size_t hash_width);
 
 #ifdef __cplusplus
 }
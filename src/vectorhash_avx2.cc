@@ -16,14 +16,19 @@
 // Platform-specific functions and macros
 
 static const size_t nreg256 = vh_nint/8;
+// the number of messages that VectorHashBatch advances in lockstep, this only pays off when the state
+// of a message takes at most two registers, otherwise there is enough parallelism and we run out of registers
+static const size_t ninter256 = ( nreg256 <= 2 ) ? 2 : 1;
+// the number of state sets that VectorHashShared advances together, these need to fit in the registers
+static const size_t nshared256 = ( nreg256 < vh_max_interleave ) ? vh_max_interleave/nreg256 : 1;
 
 #ifdef VH_INTEL
-void EXT(VectorHashBody256)(const v8si* data, v8si h1[], v8si h2[], v8si h3[], v8si h4[])
+static inline void vh_body256(const v8si* data, v8si h1[], v8si h2[], v8si h3[], v8si h4[])
 {
 	v8si s[nreg256], x1[nreg256], x2[nreg256];
 
 	VEC( nreg256, s[j] = _mm256_xor_si256(h1[j], h2[j]) );
-	VEC( nreg256, s[j] = _mm256_xor_si256(s[j], *data++) );
+	VEC( nreg256, s[j] = _mm256_xor_si256(s[j], _mm256_loadu_si256(data++)) );
 	VEC( nreg256, x1[j] = _mm256_slli_epi32(h1[j], 11) );
 	VEC( nreg256, x2[j] = _mm256_srli_epi32(h1[j], 21) );
 	VEC( nreg256, x1[j] = _mm256_or_si256(x1[j], x2[j]) );
@@ -35,7 +40,7 @@ void EXT(VectorHashBody256)(const v8si* data, v8si h1[], v8si h2[], v8si h3[], v
 	VEC( nreg256, h2[j] = _mm256_or_si256(x1[j], x2[j]) );
 
 	VEC( nreg256, s[j] = _mm256_xor_si256(h2[j], h3[j]) );
-	VEC( nreg256, s[j] = _mm256_xor_si256(s[j], *data++) );
+	VEC( nreg256, s[j] = _mm256_xor_si256(s[j], _mm256_loadu_si256(data++)) );
 	VEC( nreg256, x1[j] = _mm256_slli_epi32(h2[j], 11) );
 	VEC( nreg256, x2[j] = _mm256_srli_epi32(h2[j], 21) );
 	VEC( nreg256, x1[j] = _mm256_or_si256(x1[j], x2[j]) );
@@ -47,7 +52,7 @@ void EXT(VectorHashBody256)(const v8si* data, v8si h1[], v8si h2[], v8si h3[], v
 	VEC( nreg256, h3[j] = _mm256_or_si256(x1[j], x2[j]) );
 
 	VEC( nreg256, s[j] = _mm256_xor_si256(h3[j], h4[j]) );
-	VEC( nreg256, s[j] = _mm256_xor_si256(s[j], *data++) );
+	VEC( nreg256, s[j] = _mm256_xor_si256(s[j], _mm256_loadu_si256(data++)) );
 	VEC( nreg256, x1[j] = _mm256_slli_epi32(h3[j], 11) );
 	VEC( nreg256, x2[j] = _mm256_srli_epi32(h3[j], 21) );
 	VEC( nreg256, x1[j] = _mm256_or_si256(x1[j], x2[j]) );
@@ -59,7 +64,7 @@ void EXT(VectorHashBody256)(const v8si* data, v8si h1[], v8si h2[], v8si h3[], v
 	VEC( nreg256, h4[j] = _mm256_or_si256(x1[j], x2[j]) );
 
 	VEC( nreg256, s[j] = _mm256_xor_si256(h4[j], h1[j]) );
-	VEC( nreg256, s[j] = _mm256_xor_si256(s[j], *data++) );
+	VEC( nreg256, s[j] = _mm256_xor_si256(s[j], _mm256_loadu_si256(data++)) );
 	VEC( nreg256, x1[j] = _mm256_slli_epi32(h4[j], 11) );
 	VEC( nreg256, x2[j] = _mm256_srli_epi32(h4[j], 21) );
 	VEC( nreg256, x1[j] = _mm256_or_si256(x1[j], x2[j]) );
@@ -70,37 +75,460 @@ void EXT(VectorHashBody256)(const v8si* data, v8si h1[], v8si h2[], v8si h3[], v
 	VEC( nreg256, x2[j] = _mm256_srli_epi32(s[j], 13) );
 	VEC( nreg256, h1[j] = _mm256_or_si256(x1[j], x2[j]) );
 }
-#else
-void EXT(VectorHashBody256)(const v8si*, v8si[], v8si[], v8si[], v8si[])
+
+void EXT(VectorHashBody256)(const v8si* data, v8si h1[], v8si h2[], v8si h3[], v8si h4[])
 {
-	(void)0;
+	vh_body256(data, h1, h2, h3, h4);
 }
-#endif
 
-void EXT(VectorHash256)(const void* buffer, size_t len, uint32_t seed, void* out, size_t hw)
+// process nblocks consecutive blocks, the state is copied into local variables so that it can
+// be kept in registers for the whole loop instead of being stored and reloaded for every block
+void EXT(VectorHashBlocks256)(const v8si* data, size_t nblocks,
+							  v8si h1[], v8si h2[], v8si h3[], v8si h4[])
 {
-	v8si h1[nreg256], h2[nreg256], h3[nreg256], h4[nreg256];
-	stateinit( (uint32_t*)h1, seed, vh_nint );
-	stateinit( (uint32_t*)h2, seed, vh_nint );
-	stateinit( (uint32_t*)h3, seed, vh_nint );
-	stateinit( (uint32_t*)h4, seed, vh_nint );
+	v8si z1[nreg256], z2[nreg256], z3[nreg256], z4[nreg256];
+	VEC( nreg256, z1[j] = h1[j] );
+	VEC( nreg256, z2[j] = h2[j] );
+	VEC( nreg256, z3[j] = h3[j] );
+	VEC( nreg256, z4[j] = h4[j] );
 
-	size_t nblocks = len/blocksize;
-	const v8si* data = (const v8si*)buffer;		
+	size_t pfd;
+	size_t npf = PrefetchBlocks( nblocks*blocksize, blocksize, pfd );
 	for( size_t i=0; i < nblocks; i++ )
 	{
-		EXT(VectorHashBody256)(data, h1, h2, h3, h4);
+		if( i < npf )
+			prefetch_block( (const uint8_t*)data + pfd, blocksize );
+		vh_body256(data, z1, z2, z3, z4);
 		data += 4*nreg256;
 	}
 
+	VEC( nreg256, h1[j] = z1[j] );
+	VEC( nreg256, h2[j] = z2[j] );
+	VEC( nreg256, h3[j] = z3[j] );
+	VEC( nreg256, h4[j] = z4[j] );
+}
+
+// a single step of the body for one register, ha and hb are two consecutive state vectors
+static inline void vh_step256(v8si& ha, v8si& hb, v8si d)
+{
+	v8si s = _mm256_xor_si256(ha, hb);
+	s = _mm256_xor_si256(s, d);
+	v8si x1 = _mm256_slli_epi32(ha, 11);
+	v8si x2 = _mm256_srli_epi32(ha, 21);
+	x1 = _mm256_or_si256(x1, x2);
+	x1 = _mm256_xor_si256(x1, s);
+	x2 = _mm256_slli_epi32(s, 14);
+	ha = _mm256_xor_si256(x1, x2);
+	x1 = _mm256_slli_epi32(s, 19);
+	x2 = _mm256_srli_epi32(s, 13);
+	hb = _mm256_or_si256(x1, x2);
+}
+
+static inline void vh_step256(v8si& ha, v8si& hb, const v8si* data)
+{
+	vh_step256(ha, hb, _mm256_loadu_si256(data));
+}
+
+// process nblocks blocks, but only for registers r0 .. r0+nr-1 of the virtual register
+// h1 .. h4 hold only those nr registers, this works because all lanes are independent
+void EXT(VectorHashLanes256)(const v8si* data, size_t nblocks, size_t r0, size_t nr,
+							  v8si h1[], v8si h2[], v8si h3[], v8si h4[])
+{
+	size_t pfd;
+	size_t npf = PrefetchBlocks( nblocks*blocksize, blocksize, pfd );
+	data += r0;
+	for( size_t i=0; i < nblocks; i++ )
+	{
+		// only the part of the block that is used by these registers needs to be prefetched
+		if( i < npf )
+			for( size_t k=0; k < 4; k++ )
+				prefetch_block( (const uint8_t*)(data + k*nreg256) + pfd, nr*sizeof(*data) );
+		for( size_t j=0; j < nr; j++ )
+		{
+			vh_step256(h1[j], h2[j], data + j);
+			vh_step256(h2[j], h3[j], data + nreg256 + j);
+			vh_step256(h3[j], h4[j], data + 2*nreg256 + j);
+			vh_step256(h4[j], h1[j], data + 3*nreg256 + j);
+		}
+		data += 4*nreg256;
+	}
+}
+
+// process nblocks blocks of M independent messages in lockstep. For narrow checksums each step depends
+// on the previous one, so a single message leaves most execution units idle. Interleaving the steps of
+// several messages hides that latency. The state of message m is stored in h[4*nreg256*m] onwards.
+template<size_t M>
+static inline void vh_interleave256(const v8si* data[], size_t nblocks, v8si h[])
+{
+	v8si z[M][4][nreg256];
+	for( size_t m=0; m < M; m++ )
+		for( size_t q=0; q < 4; q++ )
+			VEC( nreg256, z[m][q][j] = h[(4*m+q)*nreg256+j] );
+
+	size_t pfd;
+	size_t npf = PrefetchBlocks( nblocks*blocksize, blocksize, pfd );
+	for( size_t i=0; i < nblocks; i++ )
+	{
+		if( i < npf )
+			for( size_t m=0; m < M; m++ )
+				prefetch_block( (const uint8_t*)data[m] + pfd, blocksize );
+		for( size_t q=0; q < 4; q++ )
+			for( size_t m=0; m < M; m++ )
+				VEC( nreg256, vh_step256(z[m][q][j], z[m][(q+1)%4][j], data[m] + q*nreg256 + j) );
+		for( size_t m=0; m < M; m++ )
+			data[m] += 4*nreg256;
+	}
+
+	for( size_t m=0; m < M; m++ )
+		for( size_t q=0; q < 4; q++ )
+			VEC( nreg256, h[(4*m+q)*nreg256+j] = z[m][q][j] );
+}
+
+// process nblocks blocks of each of the m <= vh_max_interleave messages, data[] is advanced past them
+void EXT(VectorHashInterleave256)(const v8si* data[], size_t m, size_t nblocks, v8si h[])
+{
+	if( m == 4 )
+		vh_interleave256<4>(data, nblocks, h);
+	else if( m == 3 )
+		vh_interleave256<3>(data, nblocks, h);
+	else if( m == 2 )
+		vh_interleave256<2>(data, nblocks, h);
+	else if( m == 1 )
+	{
+		EXT(VectorHashBlocks256)(data[0], nblocks, h, h+nreg256, h+2*nreg256, h+3*nreg256);
+		data[0] += nblocks*4*nreg256;
+	}
+}
+
+// process nblocks blocks of the same data for M state sets in lockstep. Each register of the data is loaded
+// once and then used for all M sets, which is what is needed for checksums of one buffer with several seeds.
+// The state of set m is stored in h[4*nreg256*m] onwards.
+template<size_t M>
+static inline void vh_shared256(const v8si* data, size_t nblocks, v8si h[])
+{
+	v8si z[M][4][nreg256];
+	for( size_t m=0; m < M; m++ )
+		for( size_t q=0; q < 4; q++ )
+			VEC( nreg256, z[m][q][j] = h[(4*m+q)*nreg256+j] );
+
+	for( size_t i=0; i < nblocks; i++ )
+	{
+		for( size_t q=0; q < 4; q++ )
+			for( size_t j=0; j < nreg256; j++ )
+			{
+				v8si d = _mm256_loadu_si256(data + q*nreg256 + j);
+				for( size_t m=0; m < M; m++ )
+					vh_step256(z[m][q][j], z[m][(q+1)%4][j], d);
+			}
+		data += 4*nreg256;
+	}
+
+	for( size_t m=0; m < M; m++ )
+		for( size_t q=0; q < 4; q++ )
+			VEC( nreg256, h[(4*m+q)*nreg256+j] = z[m][q][j] );
+}
+
+// process nblocks blocks of the same data for m state sets, stored as in vh_shared256, the sets are taken
+// nshared256 at a time, so the data should be small enough to stay in the cache between the groups
+void EXT(VectorHashShared256)(const v8si* data, size_t nblocks, size_t m, v8si h[])
+{
+	for( size_t k=0; k < m; k += nshared256 )
+	{
+		v8si* hk = h + 4*nreg256*k;
+		size_t mk = min(nshared256, m-k);
+		if( mk == 4 )
+			vh_shared256<4>(data, nblocks, hk);
+		else if( mk == 3 )
+			vh_shared256<3>(data, nblocks, hk);
+		else if( mk == 2 )
+			vh_shared256<2>(data, nblocks, hk);
+		else
+			EXT(VectorHashBlocks256)(data, nblocks, hk, hk+nreg256, hk+2*nreg256, hk+3*nreg256);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Finalization - this gives results identical to EXT(VectorHashFinalize)
+
+// rotate all lanes of x left by r bits
+static inline v8si vh_rol256(v8si x, int r)
+{
+	return _mm256_or_si256(_mm256_slli_epi32(x, r), _mm256_srli_epi32(x, 32-r));
+}
+
+// the SIMD equivalent of fmix32
+static inline v8si vh_fmix256(v8si h0, v8si h1)
+{
+	h1 = _mm256_xor_si256(h1, h0);
+	h0 = _mm256_xor_si256(vh_rol256(h0, 11), h1);
+	h0 = _mm256_xor_si256(h0, vh_rol256(h1, 13));
+	h1 = vh_rol256(h1, 19);
+	return _mm256_add_epi32(h0, h1);
+}
+
+// copy the first lane of x, or the last lane of x[nreg256-1] in the second form, to all lanes
+static inline v8si vh_first256(const v8si x[])
+{
+	return _mm256_broadcastd_epi32(_mm256_castsi256_si128(x[0]));
+}
+
+static inline v8si vh_last256(const v8si x[])
+{
+	return _mm256_permutevar8x32_epi32(x[nreg256-1], _mm256_set1_epi32(7));
+}
+
+// register j of x with the words reversed within each chunk, a chunk spans one or more registers
+static inline v8si vh_mirror256(const v8si x[], size_t j)
+{
+	const v8si idx = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+	return _mm256_permutevar8x32_epi32(x[j ^ (vh_nchunk-1)/8], idx);
+}
+
+// replace x by its inclusive prefix sum over all vh_nint lanes
+static inline void vh_prefix256(v8si x[])
+{
+	v8si carry = _mm256_setzero_si256();
+	for( size_t j=0; j < nreg256; j++ )
+	{
+		v8si s = x[j];
+		s = _mm256_add_epi32(s, _mm256_slli_si256(s, 4));
+		s = _mm256_add_epi32(s, _mm256_slli_si256(s, 8));
+		// the shifts above work within each 128-bit half, add the total of the lower half to the upper half
+		v8si t = _mm256_shuffle_epi32(s, 0xff);
+		s = _mm256_add_epi32(s, _mm256_permute2x128_si256(t, t, 0x08));
+		x[j] = _mm256_add_epi32(s, carry);
+		carry = _mm256_permutevar8x32_epi32(x[j], _mm256_set1_epi32(7));
+	}
+}
+
+// Lane mixing, this is equivalent to the following loop over the lanes j > 0:
+//   a[0] += b[j]; b[0] += c[j]; c[0] += d[j]; d[0] += a[j]; a[j] += b[0]; b[j] += c[0]; c[j] += d[0]; d[j] += a[0];
+// The running totals in lane 0 are prefix sums, so all lanes can be done at once.
+static inline void vh_chain256(v8si a[], v8si b[], v8si c[], v8si d[])
+{
+	v8si pa[nreg256], pb[nreg256], pc[nreg256], pd[nreg256];
+	VEC( nreg256, pa[j] = b[j] );
+	VEC( nreg256, pb[j] = c[j] );
+	VEC( nreg256, pc[j] = d[j] );
+	VEC( nreg256, pd[j] = a[j] );
+	vh_prefix256(pa);
+	vh_prefix256(pb);
+	vh_prefix256(pc);
+	vh_prefix256(pd);
+	// pa[j] now holds b[0] + ... + b[j], this needs to become a[0] + b[1] + ... + b[j], etc.
+	v8si ea = vh_first256(a), eb = vh_first256(b), ec = vh_first256(c), ed = vh_first256(d);
+	v8si fa = _mm256_sub_epi32(ea, eb), fb = _mm256_sub_epi32(eb, ec);
+	v8si fc = _mm256_sub_epi32(ec, ed), fd = _mm256_sub_epi32(ed, ea);
+	VEC( nreg256, pa[j] = _mm256_add_epi32(pa[j], fa) );
+	VEC( nreg256, pb[j] = _mm256_add_epi32(pb[j], fb) );
+	VEC( nreg256, pc[j] = _mm256_add_epi32(pc[j], fc) );
+	VEC( nreg256, pd[j] = _mm256_add_epi32(pd[j], fd) );
+	VEC( nreg256, a[j] = _mm256_add_epi32(a[j], pb[j]) );
+	VEC( nreg256, b[j] = _mm256_add_epi32(b[j], pc[j]) );
+	VEC( nreg256, c[j] = _mm256_add_epi32(c[j], pd[j]) );
+	VEC( nreg256, d[j] = _mm256_add_epi32(d[j], pa[j]) );
+	// lane 0 ends up with the complete totals
+	a[0] = _mm256_blend_epi32(a[0], vh_last256(pa), 1);
+	b[0] = _mm256_blend_epi32(b[0], vh_last256(pb), 1);
+	c[0] = _mm256_blend_epi32(c[0], vh_last256(pc), 1);
+	d[0] = _mm256_blend_epi32(d[0], vh_last256(pd), 1);
+}
+
+static inline void vh_finalize256(size_t len, v8si h1[], v8si h2[], v8si h3[], v8si h4[], void* out, size_t hw)
+{
+	v8si lenc = _mm256_set1_epi32(int(fmix32(len & 0x7fffffff)));
+	VEC( nreg256, h1[j] = _mm256_xor_si256(h1[j], lenc) );
+	VEC( nreg256, h2[j] = _mm256_xor_si256(h2[j], lenc) );
+	VEC( nreg256, h3[j] = _mm256_xor_si256(h3[j], lenc) );
+	VEC( nreg256, h4[j] = _mm256_xor_si256(h4[j], lenc) );
+
+	vh_chain256(h1, h2, h3, h4);
+
+	VEC( nreg256, h1[j] = _mm256_add_epi32(h1[j], h2[j]) );
+	VEC( nreg256, h1[j] = _mm256_add_epi32(h1[j], h3[j]) );
+	VEC( nreg256, h1[j] = _mm256_add_epi32(h1[j], h4[j]) );
+	VEC( nreg256, h2[j] = _mm256_add_epi32(h2[j], h1[j]) );
+	VEC( nreg256, h3[j] = _mm256_add_epi32(h3[j], h1[j]) );
+	VEC( nreg256, h4[j] = _mm256_add_epi32(h4[j], h1[j]) );
+	VEC( nreg256, h1[j] = vh_fmix256(h1[j], h3[j]) );
+	VEC( nreg256, h2[j] = vh_fmix256(h2[j], h4[j]) );
+	VEC( nreg256, h3[j] = vh_fmix256(h3[j], h1[j]) );
+	VEC( nreg256, h4[j] = vh_fmix256(h4[j], h2[j]) );
+	VEC( nreg256, h1[j] = _mm256_add_epi32(h1[j], h2[j]) );
+	VEC( nreg256, h1[j] = _mm256_add_epi32(h1[j], h3[j]) );
+	VEC( nreg256, h1[j] = _mm256_add_epi32(h1[j], h4[j]) );
+	VEC( nreg256, h2[j] = _mm256_add_epi32(h2[j], h1[j]) );
+	VEC( nreg256, h3[j] = _mm256_add_epi32(h3[j], h1[j]) );
+	VEC( nreg256, h4[j] = _mm256_add_epi32(h4[j], h1[j]) );
+
+	vh_chain256(h1, h4, h3, h2);
+
+	// mix each word with the mirrored word in the chunk half a state further on
+	alignas(64) uint32_t Y[4*vh_nint];
+	v8si* y = (v8si*)Y;
+	const v8si c = _mm256_set1_epi32(int(0xd86b048b));
+	VEC( nreg256, _mm256_store_si256(y+j, vh_fmix256(_mm256_xor_si256(h1[j], vh_mirror256(h3, j)), c)) );
+	VEC( nreg256, _mm256_store_si256(y+nreg256+j, vh_fmix256(_mm256_xor_si256(h2[j], vh_mirror256(h4, j)), c)) );
+	VEC( nreg256, _mm256_store_si256(y+2*nreg256+j, vh_fmix256(_mm256_xor_si256(h3[j], vh_mirror256(h1, j)), c)) );
+	VEC( nreg256, _mm256_store_si256(y+3*nreg256+j, vh_fmix256(_mm256_xor_si256(h4[j], vh_mirror256(h2, j)), c)) );
+	vh_fold_finish( Y, out, hw );
+}
+
+void EXT(VectorHashFinalize256)(size_t len, v8si h1[], v8si h2[], v8si h3[], v8si h4[], void* out, size_t hw)
+{
+	vh_finalize256(len, h1, h2, h3, h4, out, hw);
+}
+
+//-----------------------------------------------------------------------------
+// The last block - the padded block is assembled from whole registers and is then
+// processed together with the finalization in a single routine. For messages that
+// are shorter than a block the state is set up directly from the seed, so that no
+// other routines are called at all.
+
+// this gives the same state as calling stateinit four times
+static inline void vh_init256(uint32_t seed, v8si h1[], v8si h2[], v8si h3[], v8si h4[])
+{
+	v8si s1 = _mm256_set1_epi32(int(seed));
+	seed = fmix32(seed);
+	v8si s2 = _mm256_set1_epi32(int(seed));
+	seed = fmix32(seed);
+	v8si s3 = _mm256_set1_epi32(int(seed));
+	seed = fmix32(seed);
+	v8si s4 = _mm256_set1_epi32(int(seed));
+	VEC( nreg256, h1[j] = s1 );
+	VEC( nreg256, h2[j] = s2 );
+	VEC( nreg256, h3[j] = s3 );
+	VEC( nreg256, h4[j] = s4 );
+}
+
+// store the last n < blocksize bytes of a message followed by the padding in buf, this gives the same
+// result as pad_buffer, but buf is written one register at a time, so that reading it back is fast
+static inline void vh_pad256(const uint8_t* src, size_t n, v8si buf[])
+{
+	for( size_t j=0; j < 4*nreg256; j++ )
+	{
+		size_t o = j*sizeof(v8si);
+		if( o + sizeof(v8si) <= n )
+			buf[j] = _mm256_loadu_si256((const v8si*)(src+o));
+		else if( o >= n )
+			buf[j] = _mm256_loadu_si256((const v8si*)(vh_pad_pattern+(o-n)));
+		else
+		{
+			// the register straddles the end of the message, the masked load does not touch the words
+			// beyond the end, and the padding pattern is zero in front of its first byte
+			size_t nd = (n-o)/4, nr = (n-o)%4;
+			v8si p = _mm256_loadu_si256((const v8si*)(vh_pad_pattern - (n-o)));
+			v8si mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(int(nd)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+			p = _mm256_or_si256(p, _mm256_maskload_epi32((const int*)(src+o), mask));
+			if( nr > 0 )
+			{
+				// the last word is only partially filled
+				uint32_t w = 0;
+				for( size_t k=0; k < nr; k++ )
+					w |= uint32_t(src[o+4*nd+k]) << 8*k;
+				v8si sel = _mm256_cmpeq_epi32(_mm256_set1_epi32(int(nd)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+				p = _mm256_or_si256(p, _mm256_and_si256(sel, _mm256_set1_epi32(int(w))));
+			}
+			buf[j] = p;
+		}
+	}
+}
+
+// checksum of a buffer of len bytes, of which the first ndone blocks have already been
+// processed, h1 .. h4 must hold the state after those blocks on entry
+static inline void vh_finish256(const void* buffer, size_t len, size_t ndone,
+								v8si h1[], v8si h2[], v8si h3[], v8si h4[], void* out, size_t hw)
+{
+	size_t nblocks = len/blocksize;
+	const v8si* data = (const v8si*)buffer + ndone*4*nreg256;
+	EXT(VectorHashBlocks256)(data, nblocks-ndone, h1, h2, h3, h4);
+	data += (nblocks-ndone)*4*nreg256;
+
 	// pad the remaining characters and process...
 	v8si buf[blocksize/sizeof(v8si)];
-	pad_buffer( (const uint8_t*)data, (uint8_t*)buf, len-nblocks*blocksize, blocksize );
-	EXT(VectorHashBody256)(buf, h1, h2, h3, h4);
+	vh_pad256( (const uint8_t*)data, len-nblocks*blocksize, buf );
+	vh_body256(buf, h1, h2, h3, h4);
+
+	vh_finalize256(len, h1, h2, h3, h4, out, hw);
+}
+
+void EXT(VectorHash256)(const void* buffer, size_t len, uint32_t seed, void* out, size_t hw)
+{
+	v8si h1[nreg256], h2[nreg256], h3[nreg256], h4[nreg256];
+	vh_init256(seed, h1, h2, h3, h4);
+	vh_finish256(buffer, len, 0, h1, h2, h3, h4, out, hw);
+}
+
+// checksums of n independent buffers with the same seed, the initial state is only calculated once
+// and groups of ninter256 buffers are processed in lockstep as far as their lengths allow
+void EXT(VectorHashBatch256)(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed, void* outs,
+							 size_t hw)
+{
+	v8si z[4*nreg256];
+	vh_init256(seed, z, z+nreg256, z+2*nreg256, z+3*nreg256);
 
-	uint32_t* z1 = (uint32_t*)h1;
-	uint32_t* z2 = (uint32_t*)h2;
-	uint32_t* z3 = (uint32_t*)h3;
-	uint32_t* z4 = (uint32_t*)h4;
-	EXT(VectorHashFinalize)(len, z1, z2, z3, z4, out, hw);
+	uint8_t* out = (uint8_t*)outs;
+	for( size_t k=0; k < n; k += ninter256 )
+	{
+		size_t m = min(ninter256, n-k);
+		v8si h[ninter256*4*nreg256];
+		const v8si* data[ninter256];
+		size_t ncommon = SIZE_MAX;
+		for( size_t i=0; i < m; i++ )
+		{
+			VEC( 4*nreg256, h[4*nreg256*i+j] = z[j] );
+			data[i] = (const v8si*)bufs[k+i];
+			ncommon = min(ncommon, lens[k+i]/blocksize);
+		}
+		if( m == 1 )
+			ncommon = 0;
+		EXT(VectorHashInterleave256)(data, m, ncommon, h);
+		for( size_t i=0; i < m; i++ )
+		{
+			v8si* hi = &h[4*nreg256*i];
+			vh_finish256(bufs[k+i], lens[k+i], ncommon, hi, hi+nreg256, hi+2*nreg256, hi+3*nreg256,
+						 out + (k+i)*(hw/8), hw);
+		}
+	}
+}
+#else
+void EXT(VectorHashBody256)(const v8si*, v8si[], v8si[], v8si[], v8si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashBlocks256)(const v8si*, size_t, v8si[], v8si[], v8si[], v8si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashLanes256)(const v8si*, size_t, size_t, size_t, v8si[], v8si[], v8si[], v8si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashInterleave256)(const v8si*[], size_t, size_t, v8si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashShared256)(const v8si*, size_t, size_t, v8si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashFinalize256)(size_t, v8si[], v8si[], v8si[], v8si[], void*, size_t)
+{
+	(void)0;
 }
+
+void EXT(VectorHash256)(const void*, size_t, uint32_t, void*, size_t)
+{
+	(void)0;
+}
+
+void EXT(VectorHashBatch256)(const void* const[], const size_t[], size_t, uint32_t, void*, size_t)
+{
+	(void)0;
+}
+#endif
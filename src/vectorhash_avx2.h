@@ -26,6 +26,53 @@ void VectorHashBody256_256(const v8si* data, v8si h1[], v8si h2[], v8si h3[], v8
 void VectorHashBody256_512(const v8si* data, v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
 void VectorHashBody256_1024(const v8si* data, v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
 
+void VectorHashBlocks256_32(const v8si* data, size_t nblocks,
+							v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
+void VectorHashBlocks256_64(const v8si* data, size_t nblocks,
+							v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
+void VectorHashBlocks256_128(const v8si* data, size_t nblocks,
+							v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
+void VectorHashBlocks256_256(const v8si* data, size_t nblocks,
+							v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
+void VectorHashBlocks256_512(const v8si* data, size_t nblocks,
+							v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
+void VectorHashBlocks256_1024(const v8si* data, size_t nblocks,
+							v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
+
+void VectorHashLanes256_32(const v8si* data, size_t nblocks, size_t r0, size_t nr,
+						   v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
+void VectorHashLanes256_64(const v8si* data, size_t nblocks, size_t r0, size_t nr,
+						   v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
+void VectorHashLanes256_128(const v8si* data, size_t nblocks, size_t r0, size_t nr,
+						   v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
+void VectorHashLanes256_256(const v8si* data, size_t nblocks, size_t r0, size_t nr,
+						   v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
+void VectorHashLanes256_512(const v8si* data, size_t nblocks, size_t r0, size_t nr,
+						   v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
+void VectorHashLanes256_1024(const v8si* data, size_t nblocks, size_t r0, size_t nr,
+						   v8si h1[], v8si h2[], v8si h3[], v8si h4[]);
+
+void VectorHashInterleave256_32(const v8si* data[], size_t m, size_t nblocks, v8si h[]);
+void VectorHashInterleave256_64(const v8si* data[], size_t m, size_t nblocks, v8si h[]);
+void VectorHashInterleave256_128(const v8si* data[], size_t m, size_t nblocks, v8si h[]);
+void VectorHashInterleave256_256(const v8si* data[], size_t m, size_t nblocks, v8si h[]);
+void VectorHashInterleave256_512(const v8si* data[], size_t m, size_t nblocks, v8si h[]);
+void VectorHashInterleave256_1024(const v8si* data[], size_t m, size_t nblocks, v8si h[]);
+
+void VectorHashShared256_32(const v8si* data, size_t nblocks, size_t m, v8si h[]);
+void VectorHashShared256_64(const v8si* data, size_t nblocks, size_t m, v8si h[]);
+void VectorHashShared256_128(const v8si* data, size_t nblocks, size_t m, v8si h[]);
+void VectorHashShared256_256(const v8si* data, size_t nblocks, size_t m, v8si h[]);
+void VectorHashShared256_512(const v8si* data, size_t nblocks, size_t m, v8si h[]);
+void VectorHashShared256_1024(const v8si* data, size_t nblocks, size_t m, v8si h[]);
+
+void VectorHashFinalize256_32(size_t len, v8si h1[], v8si h2[], v8si h3[], v8si h4[], void* out, size_t hw);
+void VectorHashFinalize256_64(size_t len, v8si h1[], v8si h2[], v8si h3[], v8si h4[], void* out, size_t hw);
+void VectorHashFinalize256_128(size_t len, v8si h1[], v8si h2[], v8si h3[], v8si h4[], void* out, size_t hw);
+void VectorHashFinalize256_256(size_t len, v8si h1[], v8si h2[], v8si h3[], v8si h4[], void* out, size_t hw);
+void VectorHashFinalize256_512(size_t len, v8si h1[], v8si h2[], v8si h3[], v8si h4[], void* out, size_t hw);
+void VectorHashFinalize256_1024(size_t len, v8si h1[], v8si h2[], v8si h3[], v8si h4[], void* out, size_t hw);
+
 void VectorHash256_32(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 void VectorHash256_64(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 void VectorHash256_128(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
@@ -33,4 +80,17 @@ void VectorHash256_256(const void* buf, size_t len, uint32_t seed, void* out, si
 void VectorHash256_512(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 void VectorHash256_1024(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 
+void VectorHashBatch256_32(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+						   void* outs, size_t hw);
+void VectorHashBatch256_64(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+						   void* outs, size_t hw);
+void VectorHashBatch256_128(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+							void* outs, size_t hw);
+void VectorHashBatch256_256(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+							void* outs, size_t hw);
+void VectorHashBatch256_512(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+							void* outs, size_t hw);
+void VectorHashBatch256_1024(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+							 void* outs, size_t hw);
+
 #endif
@@ -16,14 +16,19 @@
 // Platform-specific functions and macros
 
 static const size_t nreg512 = vh_nint/16;
+// the number of messages that VectorHashBatch advances in lockstep, this only pays off when the state
+// of a message takes at most two registers, otherwise there is enough parallelism and we run out of registers
+static const size_t ninter512 = ( nreg512 <= 2 ) ? 2 : 1;
+// the number of state sets that VectorHashShared advances together, these need to fit in the registers
+static const size_t nshared512 = ( nreg512 < vh_max_interleave ) ? vh_max_interleave/nreg512 : 1;
 
 #ifdef VH_INTEL
-void EXT(VectorHashBody512)(const v16si* data, v16si h1[], v16si h2[], v16si h3[], v16si h4[])
+static inline void vh_body512(const v16si* data, v16si h1[], v16si h2[], v16si h3[], v16si h4[])
 {
 	v16si s[nreg512], x1[nreg512], x2[nreg512];
 
 	VEC( nreg512, s[j] = _mm512_xor_si512(h1[j], h2[j]) );
-	VEC( nreg512, s[j] = _mm512_xor_si512(s[j], *data++) );
+	VEC( nreg512, s[j] = _mm512_xor_si512(s[j], _mm512_loadu_si512(data++)) );
 	VEC( nreg512, x1[j] = _mm512_rol_epi32(h1[j], 11) );
 	VEC( nreg512, x1[j] = _mm512_xor_si512(x1[j], s[j]) );
 	VEC( nreg512, x2[j] = _mm512_slli_epi32(s[j], 14) );
@@ -31,7 +36,7 @@ void EXT(VectorHashBody512)(const v16si* data, v16si h1[], v16si h2[], v16si h3[
 	VEC( nreg512, h2[j] = _mm512_rol_epi32(s[j], 19) );
 
 	VEC( nreg512, s[j] = _mm512_xor_si512(h2[j], h3[j]) );
-	VEC( nreg512, s[j] = _mm512_xor_si512(s[j], *data++) );
+	VEC( nreg512, s[j] = _mm512_xor_si512(s[j], _mm512_loadu_si512(data++)) );
 	VEC( nreg512, x1[j] = _mm512_rol_epi32(h2[j], 11) );
 	VEC( nreg512, x1[j] = _mm512_xor_si512(x1[j], s[j]) );
 	VEC( nreg512, x2[j] = _mm512_slli_epi32(s[j], 14) );
@@ -39,7 +44,7 @@ void EXT(VectorHashBody512)(const v16si* data, v16si h1[], v16si h2[], v16si h3[
 	VEC( nreg512, h3[j] = _mm512_rol_epi32(s[j], 19) );
 
 	VEC( nreg512, s[j] = _mm512_xor_si512(h3[j], h4[j]) );
-	VEC( nreg512, s[j] = _mm512_xor_si512(s[j], *data++) );
+	VEC( nreg512, s[j] = _mm512_xor_si512(s[j], _mm512_loadu_si512(data++)) );
 	VEC( nreg512, x1[j] = _mm512_rol_epi32(h3[j], 11) );
 	VEC( nreg512, x1[j] = _mm512_xor_si512(x1[j], s[j]) );
 	VEC( nreg512, x2[j] = _mm512_slli_epi32(s[j], 14) );
@@ -47,44 +52,458 @@ void EXT(VectorHashBody512)(const v16si* data, v16si h1[], v16si h2[], v16si h3[
 	VEC( nreg512, h4[j] = _mm512_rol_epi32(s[j], 19) );
 
 	VEC( nreg512, s[j] = _mm512_xor_si512(h4[j], h1[j]) );
-	VEC( nreg512, s[j] = _mm512_xor_si512(s[j], *data++) );
+	VEC( nreg512, s[j] = _mm512_xor_si512(s[j], _mm512_loadu_si512(data++)) );
 	VEC( nreg512, x1[j] = _mm512_rol_epi32(h4[j], 11) );
 	VEC( nreg512, x1[j] = _mm512_xor_si512(x1[j], s[j]) );
 	VEC( nreg512, x2[j] = _mm512_slli_epi32(s[j], 14) );
 	VEC( nreg512, h4[j] = _mm512_xor_si512(x1[j], x2[j]) );
 	VEC( nreg512, h1[j] = _mm512_rol_epi32(s[j], 19) );
 }
-#else
-void EXT(VectorHashBody512)(const v16si*, v16si[], v16si[], v16si[], v16si[])
+
+void EXT(VectorHashBody512)(const v16si* data, v16si h1[], v16si h2[], v16si h3[], v16si h4[])
 {
-	(void)0;
+	vh_body512(data, h1, h2, h3, h4);
 }
-#endif
 
-void EXT(VectorHash512)(const void* buffer, size_t len, uint32_t seed, void* out, size_t hw)
+// process nblocks consecutive blocks, the state is copied into local variables so that it can
+// be kept in registers for the whole loop instead of being stored and reloaded for every block
+void EXT(VectorHashBlocks512)(const v16si* data, size_t nblocks,
+							  v16si h1[], v16si h2[], v16si h3[], v16si h4[])
 {
-	v16si h1[nreg512], h2[nreg512], h3[nreg512], h4[nreg512];
-	stateinit( (uint32_t*)h1, seed, vh_nint );
-	stateinit( (uint32_t*)h2, seed, vh_nint );
-	stateinit( (uint32_t*)h3, seed, vh_nint );
-	stateinit( (uint32_t*)h4, seed, vh_nint );
+	v16si z1[nreg512], z2[nreg512], z3[nreg512], z4[nreg512];
+	VEC( nreg512, z1[j] = h1[j] );
+	VEC( nreg512, z2[j] = h2[j] );
+	VEC( nreg512, z3[j] = h3[j] );
+	VEC( nreg512, z4[j] = h4[j] );
 
-	size_t nblocks = len/blocksize;
-	const v16si* data = (const v16si*)buffer;
+	size_t pfd;
+	size_t npf = PrefetchBlocks( nblocks*blocksize, blocksize, pfd );
+	for( size_t i=0; i < nblocks; i++ )
+	{
+		if( i < npf )
+			prefetch_block( (const uint8_t*)data + pfd, blocksize );
+		vh_body512(data, z1, z2, z3, z4);
+		data += 4*nreg512;
+	}
+
+	VEC( nreg512, h1[j] = z1[j] );
+	VEC( nreg512, h2[j] = z2[j] );
+	VEC( nreg512, h3[j] = z3[j] );
+	VEC( nreg512, h4[j] = z4[j] );
+}
+
+// a single step of the body for one register, ha and hb are two consecutive state vectors
+static inline void vh_step512(v16si& ha, v16si& hb, v16si d)
+{
+	v16si s = _mm512_xor_si512(ha, hb);
+	s = _mm512_xor_si512(s, d);
+	v16si x1 = _mm512_rol_epi32(ha, 11);
+	x1 = _mm512_xor_si512(x1, s);
+	v16si x2 = _mm512_slli_epi32(s, 14);
+	ha = _mm512_xor_si512(x1, x2);
+	hb = _mm512_rol_epi32(s, 19);
+}
+
+static inline void vh_step512(v16si& ha, v16si& hb, const v16si* data)
+{
+	vh_step512(ha, hb, _mm512_loadu_si512(data));
+}
+
+// process nblocks blocks, but only for registers r0 .. r0+nr-1 of the virtual register
+// h1 .. h4 hold only those nr registers, this works because all lanes are independent
+void EXT(VectorHashLanes512)(const v16si* data, size_t nblocks, size_t r0, size_t nr,
+							  v16si h1[], v16si h2[], v16si h3[], v16si h4[])
+{
+	size_t pfd;
+	size_t npf = PrefetchBlocks( nblocks*blocksize, blocksize, pfd );
+	data += r0;
 	for( size_t i=0; i < nblocks; i++ )
 	{
-		EXT(VectorHashBody512)(data, h1, h2, h3, h4);
+		// only the part of the block that is used by these registers needs to be prefetched
+		if( i < npf )
+			for( size_t k=0; k < 4; k++ )
+				prefetch_block( (const uint8_t*)(data + k*nreg512) + pfd, nr*sizeof(*data) );
+		for( size_t j=0; j < nr; j++ )
+		{
+			vh_step512(h1[j], h2[j], data + j);
+			vh_step512(h2[j], h3[j], data + nreg512 + j);
+			vh_step512(h3[j], h4[j], data + 2*nreg512 + j);
+			vh_step512(h4[j], h1[j], data + 3*nreg512 + j);
+		}
 		data += 4*nreg512;
 	}
+}
+
+// process nblocks blocks of M independent messages in lockstep. For narrow checksums each step depends
+// on the previous one, so a single message leaves most execution units idle. Interleaving the steps of
+// several messages hides that latency. The state of message m is stored in h[4*nreg512*m] onwards.
+template<size_t M>
+static inline void vh_interleave512(const v16si* data[], size_t nblocks, v16si h[])
+{
+	v16si z[M][4][nreg512];
+	for( size_t m=0; m < M; m++ )
+		for( size_t q=0; q < 4; q++ )
+			VEC( nreg512, z[m][q][j] = h[(4*m+q)*nreg512+j] );
+
+	size_t pfd;
+	size_t npf = PrefetchBlocks( nblocks*blocksize, blocksize, pfd );
+	for( size_t i=0; i < nblocks; i++ )
+	{
+		if( i < npf )
+			for( size_t m=0; m < M; m++ )
+				prefetch_block( (const uint8_t*)data[m] + pfd, blocksize );
+		for( size_t q=0; q < 4; q++ )
+			for( size_t m=0; m < M; m++ )
+				VEC( nreg512, vh_step512(z[m][q][j], z[m][(q+1)%4][j], data[m] + q*nreg512 + j) );
+		for( size_t m=0; m < M; m++ )
+			data[m] += 4*nreg512;
+	}
+
+	for( size_t m=0; m < M; m++ )
+		for( size_t q=0; q < 4; q++ )
+			VEC( nreg512, h[(4*m+q)*nreg512+j] = z[m][q][j] );
+}
+
+// process nblocks blocks of each of the m <= vh_max_interleave messages, data[] is advanced past them
+void EXT(VectorHashInterleave512)(const v16si* data[], size_t m, size_t nblocks, v16si h[])
+{
+	if( m == 4 )
+		vh_interleave512<4>(data, nblocks, h);
+	else if( m == 3 )
+		vh_interleave512<3>(data, nblocks, h);
+	else if( m == 2 )
+		vh_interleave512<2>(data, nblocks, h);
+	else if( m == 1 )
+	{
+		EXT(VectorHashBlocks512)(data[0], nblocks, h, h+nreg512, h+2*nreg512, h+3*nreg512);
+		data[0] += nblocks*4*nreg512;
+	}
+}
+
+// process nblocks blocks of the same data for M state sets in lockstep. Each register of the data is loaded
+// once and then used for all M sets, which is what is needed for checksums of one buffer with several seeds.
+// The state of set m is stored in h[4*nreg512*m] onwards.
+template<size_t M>
+static inline void vh_shared512(const v16si* data, size_t nblocks, v16si h[])
+{
+	v16si z[M][4][nreg512];
+	for( size_t m=0; m < M; m++ )
+		for( size_t q=0; q < 4; q++ )
+			VEC( nreg512, z[m][q][j] = h[(4*m+q)*nreg512+j] );
+
+	for( size_t i=0; i < nblocks; i++ )
+	{
+		for( size_t q=0; q < 4; q++ )
+			for( size_t j=0; j < nreg512; j++ )
+			{
+				v16si d = _mm512_loadu_si512(data + q*nreg512 + j);
+				for( size_t m=0; m < M; m++ )
+					vh_step512(z[m][q][j], z[m][(q+1)%4][j], d);
+			}
+		data += 4*nreg512;
+	}
+
+	for( size_t m=0; m < M; m++ )
+		for( size_t q=0; q < 4; q++ )
+			VEC( nreg512, h[(4*m+q)*nreg512+j] = z[m][q][j] );
+}
+
+// process nblocks blocks of the same data for m state sets, stored as in vh_shared512, the sets are taken
+// nshared512 at a time, so the data should be small enough to stay in the cache between the groups
+void EXT(VectorHashShared512)(const v16si* data, size_t nblocks, size_t m, v16si h[])
+{
+	for( size_t k=0; k < m; k += nshared512 )
+	{
+		v16si* hk = h + 4*nreg512*k;
+		size_t mk = min(nshared512, m-k);
+		if( mk == 4 )
+			vh_shared512<4>(data, nblocks, hk);
+		else if( mk == 3 )
+			vh_shared512<3>(data, nblocks, hk);
+		else if( mk == 2 )
+			vh_shared512<2>(data, nblocks, hk);
+		else
+			EXT(VectorHashBlocks512)(data, nblocks, hk, hk+nreg512, hk+2*nreg512, hk+3*nreg512);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Finalization - this gives results identical to EXT(VectorHashFinalize)
+
+// the SIMD equivalent of fmix32
+static inline v16si vh_fmix512(v16si h0, v16si h1)
+{
+	h1 = _mm512_xor_si512(h1, h0);
+	h0 = _mm512_xor_si512(_mm512_rol_epi32(h0, 11), h1);
+	h0 = _mm512_xor_si512(h0, _mm512_rol_epi32(h1, 13));
+	h1 = _mm512_rol_epi32(h1, 19);
+	return _mm512_add_epi32(h0, h1);
+}
+
+// copy the first lane of x, or the last lane of x[nreg512-1] in the second form, to all lanes
+static inline v16si vh_first512(const v16si x[])
+{
+	return _mm512_permutexvar_epi32(_mm512_setzero_si512(), x[0]);
+}
+
+static inline v16si vh_last512(const v16si x[])
+{
+	return _mm512_permutexvar_epi32(_mm512_set1_epi32(15), x[nreg512-1]);
+}
+
+// register j of x with the words reversed within each chunk, the chunks are never wider than a register
+static inline v16si vh_mirror512(const v16si x[], size_t j)
+{
+	const v16si idx = _mm512_setr_epi32(int(vh_mirror(0)), int(vh_mirror(1)), int(vh_mirror(2)), int(vh_mirror(3)),
+										int(vh_mirror(4)), int(vh_mirror(5)), int(vh_mirror(6)), int(vh_mirror(7)),
+										int(vh_mirror(8)), int(vh_mirror(9)), int(vh_mirror(10)), int(vh_mirror(11)),
+										int(vh_mirror(12)), int(vh_mirror(13)), int(vh_mirror(14)), int(vh_mirror(15)));
+	return _mm512_permutexvar_epi32(idx, x[j]);
+}
+
+// replace x by its inclusive prefix sum over all vh_nint lanes
+static inline void vh_prefix512(v16si x[])
+{
+	const v16si zero = _mm512_setzero_si512();
+	v16si carry = zero;
+	for( size_t j=0; j < nreg512; j++ )
+	{
+		v16si s = x[j];
+		s = _mm512_add_epi32(s, _mm512_alignr_epi32(s, zero, 15));
+		s = _mm512_add_epi32(s, _mm512_alignr_epi32(s, zero, 14));
+		s = _mm512_add_epi32(s, _mm512_alignr_epi32(s, zero, 12));
+		s = _mm512_add_epi32(s, _mm512_alignr_epi32(s, zero, 8));
+		x[j] = _mm512_add_epi32(s, carry);
+		carry = _mm512_permutexvar_epi32(_mm512_set1_epi32(15), x[j]);
+	}
+}
+
+// Lane mixing, this is equivalent to the following loop over the lanes j > 0:
+//   a[0] += b[j]; b[0] += c[j]; c[0] += d[j]; d[0] += a[j]; a[j] += b[0]; b[j] += c[0]; c[j] += d[0]; d[j] += a[0];
+// The running totals in lane 0 are prefix sums, so all lanes can be done at once.
+static inline void vh_chain512(v16si a[], v16si b[], v16si c[], v16si d[])
+{
+	v16si pa[nreg512], pb[nreg512], pc[nreg512], pd[nreg512];
+	VEC( nreg512, pa[j] = b[j] );
+	VEC( nreg512, pb[j] = c[j] );
+	VEC( nreg512, pc[j] = d[j] );
+	VEC( nreg512, pd[j] = a[j] );
+	vh_prefix512(pa);
+	vh_prefix512(pb);
+	vh_prefix512(pc);
+	vh_prefix512(pd);
+	// pa[j] now holds b[0] + ... + b[j], this needs to become a[0] + b[1] + ... + b[j], etc.
+	v16si ea = vh_first512(a), eb = vh_first512(b), ec = vh_first512(c), ed = vh_first512(d);
+	v16si fa = _mm512_sub_epi32(ea, eb), fb = _mm512_sub_epi32(eb, ec);
+	v16si fc = _mm512_sub_epi32(ec, ed), fd = _mm512_sub_epi32(ed, ea);
+	VEC( nreg512, pa[j] = _mm512_add_epi32(pa[j], fa) );
+	VEC( nreg512, pb[j] = _mm512_add_epi32(pb[j], fb) );
+	VEC( nreg512, pc[j] = _mm512_add_epi32(pc[j], fc) );
+	VEC( nreg512, pd[j] = _mm512_add_epi32(pd[j], fd) );
+	VEC( nreg512, a[j] = _mm512_add_epi32(a[j], pb[j]) );
+	VEC( nreg512, b[j] = _mm512_add_epi32(b[j], pc[j]) );
+	VEC( nreg512, c[j] = _mm512_add_epi32(c[j], pd[j]) );
+	VEC( nreg512, d[j] = _mm512_add_epi32(d[j], pa[j]) );
+	// lane 0 ends up with the complete totals
+	a[0] = _mm512_mask_mov_epi32(a[0], 1, vh_last512(pa));
+	b[0] = _mm512_mask_mov_epi32(b[0], 1, vh_last512(pb));
+	c[0] = _mm512_mask_mov_epi32(c[0], 1, vh_last512(pc));
+	d[0] = _mm512_mask_mov_epi32(d[0], 1, vh_last512(pd));
+}
+
+static inline void vh_finalize512(size_t len, v16si h1[], v16si h2[], v16si h3[], v16si h4[], void* out, size_t hw)
+{
+	v16si lenc = _mm512_set1_epi32(int(fmix32(len & 0x7fffffff)));
+	VEC( nreg512, h1[j] = _mm512_xor_si512(h1[j], lenc) );
+	VEC( nreg512, h2[j] = _mm512_xor_si512(h2[j], lenc) );
+	VEC( nreg512, h3[j] = _mm512_xor_si512(h3[j], lenc) );
+	VEC( nreg512, h4[j] = _mm512_xor_si512(h4[j], lenc) );
+
+	vh_chain512(h1, h2, h3, h4);
+
+	VEC( nreg512, h1[j] = _mm512_add_epi32(h1[j], h2[j]) );
+	VEC( nreg512, h1[j] = _mm512_add_epi32(h1[j], h3[j]) );
+	VEC( nreg512, h1[j] = _mm512_add_epi32(h1[j], h4[j]) );
+	VEC( nreg512, h2[j] = _mm512_add_epi32(h2[j], h1[j]) );
+	VEC( nreg512, h3[j] = _mm512_add_epi32(h3[j], h1[j]) );
+	VEC( nreg512, h4[j] = _mm512_add_epi32(h4[j], h1[j]) );
+	VEC( nreg512, h1[j] = vh_fmix512(h1[j], h3[j]) );
+	VEC( nreg512, h2[j] = vh_fmix512(h2[j], h4[j]) );
+	VEC( nreg512, h3[j] = vh_fmix512(h3[j], h1[j]) );
+	VEC( nreg512, h4[j] = vh_fmix512(h4[j], h2[j]) );
+	VEC( nreg512, h1[j] = _mm512_add_epi32(h1[j], h2[j]) );
+	VEC( nreg512, h1[j] = _mm512_add_epi32(h1[j], h3[j]) );
+	VEC( nreg512, h1[j] = _mm512_add_epi32(h1[j], h4[j]) );
+	VEC( nreg512, h2[j] = _mm512_add_epi32(h2[j], h1[j]) );
+	VEC( nreg512, h3[j] = _mm512_add_epi32(h3[j], h1[j]) );
+	VEC( nreg512, h4[j] = _mm512_add_epi32(h4[j], h1[j]) );
+
+	vh_chain512(h1, h4, h3, h2);
+
+	// mix each word with the mirrored word in the chunk half a state further on
+	alignas(64) uint32_t Y[4*vh_nint];
+	v16si* y = (v16si*)Y;
+	const v16si c = _mm512_set1_epi32(int(0xd86b048b));
+	VEC( nreg512, _mm512_store_si512(y+j, vh_fmix512(_mm512_xor_si512(h1[j], vh_mirror512(h3, j)), c)) );
+	VEC( nreg512, _mm512_store_si512(y+nreg512+j, vh_fmix512(_mm512_xor_si512(h2[j], vh_mirror512(h4, j)), c)) );
+	VEC( nreg512, _mm512_store_si512(y+2*nreg512+j, vh_fmix512(_mm512_xor_si512(h3[j], vh_mirror512(h1, j)), c)) );
+	VEC( nreg512, _mm512_store_si512(y+3*nreg512+j, vh_fmix512(_mm512_xor_si512(h4[j], vh_mirror512(h2, j)), c)) );
+	vh_fold_finish( Y, out, hw );
+}
+
+void EXT(VectorHashFinalize512)(size_t len, v16si h1[], v16si h2[], v16si h3[], v16si h4[], void* out, size_t hw)
+{
+	vh_finalize512(len, h1, h2, h3, h4, out, hw);
+}
+
+//-----------------------------------------------------------------------------
+// The last block - the padded block is assembled from whole registers and is then
+// processed together with the finalization in a single routine. For messages that
+// are shorter than a block the state is set up directly from the seed, so that no
+// other routines are called at all.
+
+// this gives the same state as calling stateinit four times
+static inline void vh_init512(uint32_t seed, v16si h1[], v16si h2[], v16si h3[], v16si h4[])
+{
+	v16si s1 = _mm512_set1_epi32(int(seed));
+	seed = fmix32(seed);
+	v16si s2 = _mm512_set1_epi32(int(seed));
+	seed = fmix32(seed);
+	v16si s3 = _mm512_set1_epi32(int(seed));
+	seed = fmix32(seed);
+	v16si s4 = _mm512_set1_epi32(int(seed));
+	VEC( nreg512, h1[j] = s1 );
+	VEC( nreg512, h2[j] = s2 );
+	VEC( nreg512, h3[j] = s3 );
+	VEC( nreg512, h4[j] = s4 );
+}
+
+// store the last n < blocksize bytes of a message followed by the padding in buf, this gives the same
+// result as pad_buffer, but buf is written one register at a time, so that reading it back is fast
+static inline void vh_pad512(const uint8_t* src, size_t n, v16si buf[])
+{
+	for( size_t j=0; j < 4*nreg512; j++ )
+	{
+		size_t o = j*sizeof(v16si);
+		if( o + sizeof(v16si) <= n )
+			buf[j] = _mm512_loadu_si512(src+o);
+		else if( o >= n )
+			buf[j] = _mm512_loadu_si512(vh_pad_pattern+(o-n));
+		else
+		{
+			// the register straddles the end of the message, the masked load does not touch the words
+			// beyond the end, and the padding pattern is zero in front of its first byte
+			size_t nd = (n-o)/4, nr = (n-o)%4;
+			v16si p = _mm512_loadu_si512(vh_pad_pattern - (n-o));
+			p = _mm512_or_si512(p, _mm512_maskz_loadu_epi32(__mmask16((1u << nd) - 1), src+o));
+			if( nr > 0 )
+			{
+				// the last word is only partially filled
+				uint32_t w = 0;
+				for( size_t k=0; k < nr; k++ )
+					w |= uint32_t(src[o+4*nd+k]) << 8*k;
+				p = _mm512_mask_or_epi32(p, __mmask16(1u << nd), p, _mm512_set1_epi32(int(w)));
+			}
+			buf[j] = p;
+		}
+	}
+}
+
+// checksum of a buffer of len bytes, of which the first ndone blocks have already been
+// processed, h1 .. h4 must hold the state after those blocks on entry
+static inline void vh_finish512(const void* buffer, size_t len, size_t ndone,
+								v16si h1[], v16si h2[], v16si h3[], v16si h4[], void* out, size_t hw)
+{
+	size_t nblocks = len/blocksize;
+	const v16si* data = (const v16si*)buffer + ndone*4*nreg512;
+	EXT(VectorHashBlocks512)(data, nblocks-ndone, h1, h2, h3, h4);
+	data += (nblocks-ndone)*4*nreg512;
 
 	// pad the remaining characters and process...
 	v16si buf[blocksize/sizeof(v16si)];
-	pad_buffer( (const uint8_t*)data, (uint8_t*)buf, len-nblocks*blocksize, blocksize );
-	EXT(VectorHashBody512)(buf, h1, h2, h3, h4);
+	vh_pad512( (const uint8_t*)data, len-nblocks*blocksize, buf );
+	vh_body512(buf, h1, h2, h3, h4);
+
+	vh_finalize512(len, h1, h2, h3, h4, out, hw);
+}
 
-	uint32_t* z1 = (uint32_t*)h1;
-	uint32_t* z2 = (uint32_t*)h2;
-	uint32_t* z3 = (uint32_t*)h3;
-	uint32_t* z4 = (uint32_t*)h4;
-	EXT(VectorHashFinalize)(len, z1, z2, z3, z4, out, hw);
+void EXT(VectorHash512)(const void* buffer, size_t len, uint32_t seed, void* out, size_t hw)
+{
+	v16si h1[nreg512], h2[nreg512], h3[nreg512], h4[nreg512];
+	vh_init512(seed, h1, h2, h3, h4);
+	vh_finish512(buffer, len, 0, h1, h2, h3, h4, out, hw);
 }
+
+// checksums of n independent buffers with the same seed, the initial state is only calculated once
+// and groups of ninter512 buffers are processed in lockstep as far as their lengths allow
+void EXT(VectorHashBatch512)(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed, void* outs,
+							 size_t hw)
+{
+	v16si z[4*nreg512];
+	vh_init512(seed, z, z+nreg512, z+2*nreg512, z+3*nreg512);
+
+	uint8_t* out = (uint8_t*)outs;
+	for( size_t k=0; k < n; k += ninter512 )
+	{
+		size_t m = min(ninter512, n-k);
+		v16si h[ninter512*4*nreg512];
+		const v16si* data[ninter512];
+		size_t ncommon = SIZE_MAX;
+		for( size_t i=0; i < m; i++ )
+		{
+			VEC( 4*nreg512, h[4*nreg512*i+j] = z[j] );
+			data[i] = (const v16si*)bufs[k+i];
+			ncommon = min(ncommon, lens[k+i]/blocksize);
+		}
+		if( m == 1 )
+			ncommon = 0;
+		EXT(VectorHashInterleave512)(data, m, ncommon, h);
+		for( size_t i=0; i < m; i++ )
+		{
+			v16si* hi = &h[4*nreg512*i];
+			vh_finish512(bufs[k+i], lens[k+i], ncommon, hi, hi+nreg512, hi+2*nreg512, hi+3*nreg512,
+						 out + (k+i)*(hw/8), hw);
+		}
+	}
+}
+#else
+void EXT(VectorHashBody512)(const v16si*, v16si[], v16si[], v16si[], v16si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashBlocks512)(const v16si*, size_t, v16si[], v16si[], v16si[], v16si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashLanes512)(const v16si*, size_t, size_t, size_t, v16si[], v16si[], v16si[], v16si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashInterleave512)(const v16si*[], size_t, size_t, v16si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashShared512)(const v16si*, size_t, size_t, v16si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashFinalize512)(size_t, v16si[], v16si[], v16si[], v16si[], void*, size_t)
+{
+	(void)0;
+}
+
+void EXT(VectorHash512)(const void*, size_t, uint32_t, void*, size_t)
+{
+	(void)0;
+}
+
+void EXT(VectorHashBatch512)(const void* const[], const size_t[], size_t, uint32_t, void*, size_t)
+{
+	(void)0;
+}
+#endif
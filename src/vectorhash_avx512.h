@@ -26,6 +26,53 @@ void VectorHashBody512_256(const v16si* data, v16si h1[], v16si h2[], v16si h3[]
 void VectorHashBody512_512(const v16si* data, v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
 void VectorHashBody512_1024(const v16si* data, v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
 
+void VectorHashBlocks512_32(const v16si* data, size_t nblocks,
+							v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
+void VectorHashBlocks512_64(const v16si* data, size_t nblocks,
+							v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
+void VectorHashBlocks512_128(const v16si* data, size_t nblocks,
+							v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
+void VectorHashBlocks512_256(const v16si* data, size_t nblocks,
+							v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
+void VectorHashBlocks512_512(const v16si* data, size_t nblocks,
+							v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
+void VectorHashBlocks512_1024(const v16si* data, size_t nblocks,
+							v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
+
+void VectorHashLanes512_32(const v16si* data, size_t nblocks, size_t r0, size_t nr,
+						   v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
+void VectorHashLanes512_64(const v16si* data, size_t nblocks, size_t r0, size_t nr,
+						   v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
+void VectorHashLanes512_128(const v16si* data, size_t nblocks, size_t r0, size_t nr,
+						   v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
+void VectorHashLanes512_256(const v16si* data, size_t nblocks, size_t r0, size_t nr,
+						   v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
+void VectorHashLanes512_512(const v16si* data, size_t nblocks, size_t r0, size_t nr,
+						   v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
+void VectorHashLanes512_1024(const v16si* data, size_t nblocks, size_t r0, size_t nr,
+						   v16si h1[], v16si h2[], v16si h3[], v16si h4[]);
+
+void VectorHashInterleave512_32(const v16si* data[], size_t m, size_t nblocks, v16si h[]);
+void VectorHashInterleave512_64(const v16si* data[], size_t m, size_t nblocks, v16si h[]);
+void VectorHashInterleave512_128(const v16si* data[], size_t m, size_t nblocks, v16si h[]);
+void VectorHashInterleave512_256(const v16si* data[], size_t m, size_t nblocks, v16si h[]);
+void VectorHashInterleave512_512(const v16si* data[], size_t m, size_t nblocks, v16si h[]);
+void VectorHashInterleave512_1024(const v16si* data[], size_t m, size_t nblocks, v16si h[]);
+
+void VectorHashShared512_32(const v16si* data, size_t nblocks, size_t m, v16si h[]);
+void VectorHashShared512_64(const v16si* data, size_t nblocks, size_t m, v16si h[]);
+void VectorHashShared512_128(const v16si* data, size_t nblocks, size_t m, v16si h[]);
+void VectorHashShared512_256(const v16si* data, size_t nblocks, size_t m, v16si h[]);
+void VectorHashShared512_512(const v16si* data, size_t nblocks, size_t m, v16si h[]);
+void VectorHashShared512_1024(const v16si* data, size_t nblocks, size_t m, v16si h[]);
+
+void VectorHashFinalize512_32(size_t len, v16si h1[], v16si h2[], v16si h3[], v16si h4[], void* out, size_t hw);
+void VectorHashFinalize512_64(size_t len, v16si h1[], v16si h2[], v16si h3[], v16si h4[], void* out, size_t hw);
+void VectorHashFinalize512_128(size_t len, v16si h1[], v16si h2[], v16si h3[], v16si h4[], void* out, size_t hw);
+void VectorHashFinalize512_256(size_t len, v16si h1[], v16si h2[], v16si h3[], v16si h4[], void* out, size_t hw);
+void VectorHashFinalize512_512(size_t len, v16si h1[], v16si h2[], v16si h3[], v16si h4[], void* out, size_t hw);
+void VectorHashFinalize512_1024(size_t len, v16si h1[], v16si h2[], v16si h3[], v16si h4[], void* out, size_t hw);
+
 void VectorHash512_32(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 void VectorHash512_64(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 void VectorHash512_128(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
@@ -33,4 +80,17 @@ void VectorHash512_256(const void* buf, size_t len, uint32_t seed, void* out, si
 void VectorHash512_512(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 void VectorHash512_1024(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 
+void VectorHashBatch512_32(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+						   void* outs, size_t hw);
+void VectorHashBatch512_64(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+						   void* outs, size_t hw);
+void VectorHashBatch512_128(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+							void* outs, size_t hw);
+void VectorHashBatch512_256(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+							void* outs, size_t hw);
+void VectorHashBatch512_512(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+							void* outs, size_t hw);
+void VectorHashBatch512_1024(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+							 void* outs, size_t hw);
+
 #endif
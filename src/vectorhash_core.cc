@@ -9,10 +9,12 @@
 
 #include <iostream>
 #include <iomanip>
+#include <atomic>
 #include "../cpuid/cpuinfo.hpp"
 #include "vectorhash.h"
 #include "vectorhash_priv.h"
 #include "vectorhash_core.h"
+#include "vectorhash_finalize.h"
 #include "vectorhash_avx512.h"
 #include "vectorhash_avx2.h"
 #include "vectorhash_sse2.h"
@@ -25,6 +27,22 @@ void stateinit(uint32_t st[], uint32_t& seed, size_t lvh_nint)
 	seed = fmix32(seed);
 }
 
+#define VH_ZERO16 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+#define VH_PAD16(n) uint8_t(n+1), uint8_t(n+2), uint8_t(n+3), uint8_t(n+4), uint8_t(n+5), uint8_t(n+6), \
+	uint8_t(n+7), uint8_t(n+8), uint8_t(n+9), uint8_t(n+10), uint8_t(n+11), uint8_t(n+12), uint8_t(n+13), \
+	uint8_t(n+14), uint8_t(n+15), uint8_t(n+16)
+#define VH_PAD256 VH_PAD16(0), VH_PAD16(16), VH_PAD16(32), VH_PAD16(48), VH_PAD16(64), VH_PAD16(80), \
+	VH_PAD16(96), VH_PAD16(112), VH_PAD16(128), VH_PAD16(144), VH_PAD16(160), VH_PAD16(176), \
+	VH_PAD16(192), VH_PAD16(208), VH_PAD16(224), VH_PAD16(240)
+
+alignas(64) const uint8_t vh_pad_table[vh_cacheline + 4*vh_max_nint*sizeof(uint32_t)] = {
+	VH_ZERO16, VH_ZERO16, VH_ZERO16, VH_ZERO16, VH_PAD256, VH_PAD256, VH_PAD256, VH_PAD256
+};
+
+#undef VH_PAD256
+#undef VH_PAD16
+#undef VH_ZERO16
+
 is_type GetSIMDVersion()
 {
 #ifdef VH_INTEL
@@ -50,214 +68,328 @@ is_type GetSIMDVersion()
 #endif
 }
 
-void VectorHashBody32(const uint32_t* data, uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[], size_t hw)
+//-----------------------------------------------------------------------------
+// Dispatch tables - the CPU capabilities and the width-specialized routines are
+// resolved once, after that each call is a single indirect jump
+
+typedef void (*vh_body32)(const uint32_t*, uint32_t[], uint32_t[], uint32_t[], uint32_t[]);
+typedef void (*vh_body128)(const v4si*, v4si[], v4si[], v4si[], v4si[]);
+typedef void (*vh_body256)(const v8si*, v8si[], v8si[], v8si[], v8si[]);
+typedef void (*vh_body512)(const v16si*, v16si[], v16si[], v16si[], v16si[]);
+
+static const size_t vh_nwidth = 6;
+
+static const vh_body32 body32_table[vh_nwidth] = {
+	VectorHashBody32_32, VectorHashBody32_64, VectorHashBody32_128,
+	VectorHashBody32_256, VectorHashBody32_512, VectorHashBody32_1024
+};
+
+static const vh_body128 body128_table[vh_nwidth] = {
+	VectorHashBody128_32, VectorHashBody128_64, VectorHashBody128_128,
+	VectorHashBody128_256, VectorHashBody128_512, VectorHashBody128_1024
+};
+
+static const vh_body256 body256_table[vh_nwidth] = {
+	VectorHashBody256_32, VectorHashBody256_64, VectorHashBody256_128,
+	VectorHashBody256_256, VectorHashBody256_512, VectorHashBody256_1024
+};
+
+static const vh_body512 body512_table[vh_nwidth] = {
+	VectorHashBody512_32, VectorHashBody512_64, VectorHashBody512_128,
+	VectorHashBody512_256, VectorHashBody512_512, VectorHashBody512_1024
+};
+
+typedef void (*vh_blocks32)(const uint32_t*, size_t, uint32_t[], uint32_t[], uint32_t[], uint32_t[]);
+typedef void (*vh_blocks128)(const v4si*, size_t, v4si[], v4si[], v4si[], v4si[]);
+typedef void (*vh_blocks256)(const v8si*, size_t, v8si[], v8si[], v8si[], v8si[]);
+typedef void (*vh_blocks512)(const v16si*, size_t, v16si[], v16si[], v16si[], v16si[]);
+
+static const vh_blocks32 blocks32_table[vh_nwidth] = {
+	VectorHashBlocks32_32, VectorHashBlocks32_64, VectorHashBlocks32_128,
+	VectorHashBlocks32_256, VectorHashBlocks32_512, VectorHashBlocks32_1024
+};
+
+static const vh_blocks128 blocks128_table[vh_nwidth] = {
+	VectorHashBlocks128_32, VectorHashBlocks128_64, VectorHashBlocks128_128,
+	VectorHashBlocks128_256, VectorHashBlocks128_512, VectorHashBlocks128_1024
+};
+
+static const vh_blocks256 blocks256_table[vh_nwidth] = {
+	VectorHashBlocks256_32, VectorHashBlocks256_64, VectorHashBlocks256_128,
+	VectorHashBlocks256_256, VectorHashBlocks256_512, VectorHashBlocks256_1024
+};
+
+static const vh_blocks512 blocks512_table[vh_nwidth] = {
+	VectorHashBlocks512_32, VectorHashBlocks512_64, VectorHashBlocks512_128,
+	VectorHashBlocks512_256, VectorHashBlocks512_512, VectorHashBlocks512_1024
+};
+
+typedef void (*vh_lanes32)(const uint32_t*, size_t, size_t, size_t, uint32_t[], uint32_t[], uint32_t[], uint32_t[]);
+typedef void (*vh_lanes128)(const v4si*, size_t, size_t, size_t, v4si[], v4si[], v4si[], v4si[]);
+typedef void (*vh_lanes256)(const v8si*, size_t, size_t, size_t, v8si[], v8si[], v8si[], v8si[]);
+typedef void (*vh_lanes512)(const v16si*, size_t, size_t, size_t, v16si[], v16si[], v16si[], v16si[]);
+
+static const vh_lanes32 lanes32_table[vh_nwidth] = {
+	VectorHashLanes32_32, VectorHashLanes32_64, VectorHashLanes32_128,
+	VectorHashLanes32_256, VectorHashLanes32_512, VectorHashLanes32_1024
+};
+
+static const vh_lanes128 lanes128_table[vh_nwidth] = {
+	VectorHashLanes128_32, VectorHashLanes128_64, VectorHashLanes128_128,
+	VectorHashLanes128_256, VectorHashLanes128_512, VectorHashLanes128_1024
+};
+
+static const vh_lanes256 lanes256_table[vh_nwidth] = {
+	VectorHashLanes256_32, VectorHashLanes256_64, VectorHashLanes256_128,
+	VectorHashLanes256_256, VectorHashLanes256_512, VectorHashLanes256_1024
+};
+
+static const vh_lanes512 lanes512_table[vh_nwidth] = {
+	VectorHashLanes512_32, VectorHashLanes512_64, VectorHashLanes512_128,
+	VectorHashLanes512_256, VectorHashLanes512_512, VectorHashLanes512_1024
+};
+
+typedef void (*vh_shared32)(const uint32_t*, size_t, size_t, uint32_t[]);
+typedef void (*vh_shared128)(const v4si*, size_t, size_t, v4si[]);
+typedef void (*vh_shared256)(const v8si*, size_t, size_t, v8si[]);
+typedef void (*vh_shared512)(const v16si*, size_t, size_t, v16si[]);
+
+static const vh_shared32 shared32_table[vh_nwidth] = {
+	VectorHashShared32_32, VectorHashShared32_64, VectorHashShared32_128,
+	VectorHashShared32_256, VectorHashShared32_512, VectorHashShared32_1024
+};
+
+static const vh_shared128 shared128_table[vh_nwidth] = {
+	VectorHashShared128_32, VectorHashShared128_64, VectorHashShared128_128,
+	VectorHashShared128_256, VectorHashShared128_512, VectorHashShared128_1024
+};
+
+static const vh_shared256 shared256_table[vh_nwidth] = {
+	VectorHashShared256_32, VectorHashShared256_64, VectorHashShared256_128,
+	VectorHashShared256_256, VectorHashShared256_512, VectorHashShared256_1024
+};
+
+static const vh_shared512 shared512_table[vh_nwidth] = {
+	VectorHashShared512_32, VectorHashShared512_64, VectorHashShared512_128,
+	VectorHashShared512_256, VectorHashShared512_512, VectorHashShared512_1024
+};
+
+typedef void (*vh_finalize32)(size_t, uint32_t[], uint32_t[], uint32_t[], uint32_t[], void*, size_t);
+typedef void (*vh_finalize128)(size_t, v4si[], v4si[], v4si[], v4si[], void*, size_t);
+typedef void (*vh_finalize256)(size_t, v8si[], v8si[], v8si[], v8si[], void*, size_t);
+typedef void (*vh_finalize512)(size_t, v16si[], v16si[], v16si[], v16si[], void*, size_t);
+
+static const vh_finalize32 finalize32_table[vh_nwidth] = {
+	VectorHashFinalize_32, VectorHashFinalize_64, VectorHashFinalize_128,
+	VectorHashFinalize_256, VectorHashFinalize_512, VectorHashFinalize_1024
+};
+
+static const vh_finalize128 finalize128_table[vh_nwidth] = {
+	VectorHashFinalize128_32, VectorHashFinalize128_64, VectorHashFinalize128_128,
+	VectorHashFinalize128_256, VectorHashFinalize128_512, VectorHashFinalize128_1024
+};
+
+static const vh_finalize256 finalize256_table[vh_nwidth] = {
+	VectorHashFinalize256_32, VectorHashFinalize256_64, VectorHashFinalize256_128,
+	VectorHashFinalize256_256, VectorHashFinalize256_512, VectorHashFinalize256_1024
+};
+
+static const vh_finalize512 finalize512_table[vh_nwidth] = {
+	VectorHashFinalize512_32, VectorHashFinalize512_64, VectorHashFinalize512_128,
+	VectorHashFinalize512_256, VectorHashFinalize512_512, VectorHashFinalize512_1024
+};
+
+// the first index is the SIMD version, the second the rounded hash width
+static const vh_impl hash_table[IS_AVX512+1][vh_nwidth] = {
+	{ VectorHash32_32, VectorHash32_64, VectorHash32_128,
+	  VectorHash32_256, VectorHash32_512, VectorHash32_1024 },
+	{ VectorHash128_32, VectorHash128_64, VectorHash128_128,
+	  VectorHash128_256, VectorHash128_512, VectorHash128_1024 },
+	{ VectorHash256_32, VectorHash256_64, VectorHash256_128,
+	  VectorHash256_256, VectorHash256_512, VectorHash256_1024 },
+	{ VectorHash512_32, VectorHash512_64, VectorHash512_128,
+	  VectorHash512_256, VectorHash512_512, VectorHash512_1024 }
+};
+
+typedef void (*vh_batch)(const void* const[], const size_t[], size_t, uint32_t, void*, size_t);
+
+static const vh_batch batch_table[IS_AVX512+1][vh_nwidth] = {
+	{ VectorHashBatch32_32, VectorHashBatch32_64, VectorHashBatch32_128,
+	  VectorHashBatch32_256, VectorHashBatch32_512, VectorHashBatch32_1024 },
+	{ VectorHashBatch128_32, VectorHashBatch128_64, VectorHashBatch128_128,
+	  VectorHashBatch128_256, VectorHashBatch128_512, VectorHashBatch128_1024 },
+	{ VectorHashBatch256_32, VectorHashBatch256_64, VectorHashBatch256_128,
+	  VectorHashBatch256_256, VectorHashBatch256_512, VectorHashBatch256_1024 },
+	{ VectorHashBatch512_32, VectorHashBatch512_64, VectorHashBatch512_128,
+	  VectorHashBatch512_256, VectorHashBatch512_512, VectorHashBatch512_1024 }
+};
+
+// return the index into the dispatch tables for the rounded hash width
+static size_t WidthIndex(size_t hw)
 {
-	uint32_t rhw =  pow2roundup(hw);
-	if( rhw == 32 )
-		VectorHashBody32_32(data, h1, h2, h3, h4);
-	else if( rhw == 64 )
-		VectorHashBody32_64(data, h1, h2, h3, h4);
-	else if( rhw == 128 )
-		VectorHashBody32_128(data, h1, h2, h3, h4);
-	else if( rhw == 256 )
-		VectorHashBody32_256(data, h1, h2, h3, h4);
-	else if( rhw == 512 )
-		VectorHashBody32_512(data, h1, h2, h3, h4);
-	else if( rhw == 1024 )
-		VectorHashBody32_1024(data, h1, h2, h3, h4);
-	else
+	uint32_t rhw = ( hw >= 32 && hw <= 1024 ) ? pow2roundup(hw) : 0;
+	for( size_t i=0; i < vh_nwidth; i++ )
+		if( rhw == (32u << i) )
+			return i;
+	cout << "Internal error: impossible value for rounded hash width: " << rhw << "." << endl;
+	exit(1);
+}
+
+static void CheckSIMDVersion(is_type SIMDversion)
+{
+	if( SIMDversion < IS_SCALAR || SIMDversion > IS_AVX512 )
 	{
-		cout << "Internal error: impossible value for rounded hash width: " << rhw << "." << endl;
+		cout << "Internal error: impossible value for SIMD version: " << SIMDversion << "." << endl;
 		exit(1);
 	}
 }
 
+// the distance at which data is prefetched, 0 means that prefetching is disabled
+static atomic<size_t> prefetch_distance( vh_prefetch_default );
+
+void VectorHashSetPrefetch(size_t distance)
+{
+	prefetch_distance.store( distance, memory_order_relaxed );
+}
+
+size_t VectorHashGetPrefetch()
+{
+	return prefetch_distance.load( memory_order_relaxed );
+}
+
+size_t PrefetchBlocks(size_t len, size_t bs, size_t& dist)
+{
+	dist = prefetch_distance.load( memory_order_relaxed );
+	if( dist == 0 || len < vh_prefetch_min )
+		return 0;
+	size_t nblocks = len/bs;
+	size_t ahead = (dist + bs - 1)/bs;
+	return ( nblocks > ahead ) ? nblocks - ahead : 0;
+}
+
+is_type GetCachedSIMDVersion()
+{
+	// CPUID is executed only once, the initialization of a static local is thread-safe in C++11
+	static const is_type SIMDversion = GetSIMDVersion();
+	return SIMDversion;
+}
+
+void VectorHashBody32(const uint32_t* data, uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[], size_t hw)
+{
+	body32_table[WidthIndex(hw)](data, h1, h2, h3, h4);
+}
+
 void VectorHashBody128(const v4si* data, v4si h1[], v4si h2[], v4si h3[], v4si h4[], size_t hw)
 {
-	uint32_t rhw =  pow2roundup(hw);
-	if( rhw == 32 )
-		VectorHashBody128_32(data, h1, h2, h3, h4);
-	else if( rhw == 64 )
-		VectorHashBody128_64(data, h1, h2, h3, h4);
-	else if( rhw == 128 )
-		VectorHashBody128_128(data, h1, h2, h3, h4);
-	else if( rhw == 256 )
-		VectorHashBody128_256(data, h1, h2, h3, h4);
-	else if( rhw == 512 )
-		VectorHashBody128_512(data, h1, h2, h3, h4);
-	else if( rhw == 1024 )
-		VectorHashBody128_1024(data, h1, h2, h3, h4);
-	else
-	{
-		cout << "Internal error: impossible value for rounded hash width: " << rhw << "." << endl;
-		exit(1);
-	}
+	body128_table[WidthIndex(hw)](data, h1, h2, h3, h4);
 }
 
 void VectorHashBody256(const v8si* data, v8si h1[], v8si h2[], v8si h3[], v8si h4[], size_t hw)
 {
-	uint32_t rhw =  pow2roundup(hw);
-	if( rhw == 32 )
-		VectorHashBody256_32(data, h1, h2, h3, h4);
-	else if( rhw == 64 )
-		VectorHashBody256_64(data, h1, h2, h3, h4);
-	else if( rhw == 128 )
-		VectorHashBody256_128(data, h1, h2, h3, h4);
-	else if( rhw == 256 )
-		VectorHashBody256_256(data, h1, h2, h3, h4);
-	else if( rhw == 512 )
-		VectorHashBody256_512(data, h1, h2, h3, h4);
-	else if( rhw == 1024 )
-		VectorHashBody256_1024(data, h1, h2, h3, h4);
-	else
-	{
-		cout << "Internal error: impossible value for rounded hash width: " << rhw << "." << endl;
-		exit(1);
-	}
+	body256_table[WidthIndex(hw)](data, h1, h2, h3, h4);
 }
 
 void VectorHashBody512(const v16si* data, v16si h1[], v16si h2[], v16si h3[], v16si h4[], size_t hw)
 {
-	uint32_t rhw =  pow2roundup(hw);
-	if( rhw == 32 )
-		VectorHashBody512_32(data, h1, h2, h3, h4);
-	else if( rhw == 64 )
-		VectorHashBody512_64(data, h1, h2, h3, h4);
-	else if( rhw == 128 )
-		VectorHashBody512_128(data, h1, h2, h3, h4);
-	else if( rhw == 256 )
-		VectorHashBody512_256(data, h1, h2, h3, h4);
-	else if( rhw == 512 )
-		VectorHashBody512_512(data, h1, h2, h3, h4);
-	else if( rhw == 1024 )
-		VectorHashBody512_1024(data, h1, h2, h3, h4);
-	else
-	{
-		cout << "Internal error: impossible value for rounded hash width: " << rhw << "." << endl;
-		exit(1);
-	}
+	body512_table[WidthIndex(hw)](data, h1, h2, h3, h4);
 }
 
-static void VectorHash32(const void* buf, size_t len, uint32_t seed, void* out, size_t hw)
+void VectorHashBlocks(const void* data, size_t nblocks, uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[],
+					  is_type SIMDversion, size_t hw)
 {
-	uint32_t rhw =  pow2roundup(hw);
-	if( rhw == 32 )
-		VectorHash32_32(buf, len, seed, out, hw);
-	else if( rhw == 64 )
-		VectorHash32_64(buf, len, seed, out, hw);
-	else if( rhw == 128 )
-		VectorHash32_128(buf, len, seed, out, hw);
-	else if( rhw == 256 )
-		VectorHash32_256(buf, len, seed, out, hw);
-	else if( rhw == 512 )
-		VectorHash32_512(buf, len, seed, out, hw);
-	else if( rhw == 1024 )
-		VectorHash32_1024(buf, len, seed, out, hw);
+	// h1 .. h4 must be aligned on a 64-byte boundary, data can have any alignment
+	size_t iw = WidthIndex(hw);
+	CheckSIMDVersion(SIMDversion);
+	if( SIMDversion == IS_AVX512 )
+		blocks512_table[iw]((const v16si*)data, nblocks, (v16si*)h1, (v16si*)h2, (v16si*)h3, (v16si*)h4);
+	else if( SIMDversion == IS_AVX2 )
+		blocks256_table[iw]((const v8si*)data, nblocks, (v8si*)h1, (v8si*)h2, (v8si*)h3, (v8si*)h4);
+	else if( SIMDversion == IS_SSE2 )
+		blocks128_table[iw]((const v4si*)data, nblocks, (v4si*)h1, (v4si*)h2, (v4si*)h3, (v4si*)h4);
 	else
-	{
-		cout << "Internal error: impossible value for rounded hash width: " << rhw << "." << endl;
-		exit(1);
-	}
+		blocks32_table[iw]((const uint32_t*)data, nblocks, h1, h2, h3, h4);
 }
 
-static void VectorHash128(const void* buf, size_t len, uint32_t seed, void* out, size_t hw)
+void VectorHashLanes(const void* data, size_t nblocks, size_t lane0, size_t nlanes,
+					 uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[], is_type SIMDversion, size_t hw)
 {
-	uint32_t rhw =  pow2roundup(hw);
-	if( rhw == 32 )
-		VectorHash128_32(buf, len, seed, out, hw);
-	else if( rhw == 64 )
-		VectorHash128_64(buf, len, seed, out, hw);
-	else if( rhw == 128 )
-		VectorHash128_128(buf, len, seed, out, hw);
-	else if( rhw == 256 )
-		VectorHash128_256(buf, len, seed, out, hw);
-	else if( rhw == 512 )
-		VectorHash128_512(buf, len, seed, out, hw);
-	else if( rhw == 1024 )
-		VectorHash128_1024(buf, len, seed, out, hw);
+	// lane0 and nlanes must be multiples of the number of lanes in a hardware register
+	// h1 .. h4 only hold the nlanes lanes and must be aligned on a 64-byte boundary
+	size_t iw = WidthIndex(hw);
+	CheckSIMDVersion(SIMDversion);
+	size_t nl = lanes_per_register(SIMDversion);
+	if( SIMDversion == IS_AVX512 )
+		lanes512_table[iw]((const v16si*)data, nblocks, lane0/nl, nlanes/nl,
+						   (v16si*)h1, (v16si*)h2, (v16si*)h3, (v16si*)h4);
+	else if( SIMDversion == IS_AVX2 )
+		lanes256_table[iw]((const v8si*)data, nblocks, lane0/nl, nlanes/nl,
+						   (v8si*)h1, (v8si*)h2, (v8si*)h3, (v8si*)h4);
+	else if( SIMDversion == IS_SSE2 )
+		lanes128_table[iw]((const v4si*)data, nblocks, lane0/nl, nlanes/nl,
+						   (v4si*)h1, (v4si*)h2, (v4si*)h3, (v4si*)h4);
 	else
-	{
-		cout << "Internal error: impossible value for rounded hash width: " << rhw << "." << endl;
-		exit(1);
-	}
+		lanes32_table[iw]((const uint32_t*)data, nblocks, lane0, nlanes, h1, h2, h3, h4);
 }
 
-static void VectorHash256(const void* buf, size_t len, uint32_t seed, void* out, size_t hw)
+void VectorHashShared(const void* data, size_t nblocks, size_t m, uint32_t h[], is_type SIMDversion, size_t hw)
 {
-	uint32_t rhw =  pow2roundup(hw);
-	if( rhw == 32 )
-		VectorHash256_32(buf, len, seed, out, hw);
-	else if( rhw == 64 )
-		VectorHash256_64(buf, len, seed, out, hw);
-	else if( rhw == 128 )
-		VectorHash256_128(buf, len, seed, out, hw);
-	else if( rhw == 256 )
-		VectorHash256_256(buf, len, seed, out, hw);
-	else if( rhw == 512 )
-		VectorHash256_512(buf, len, seed, out, hw);
-	else if( rhw == 1024 )
-		VectorHash256_1024(buf, len, seed, out, hw);
+	// the state of set k is stored in h[4*nint*k] onwards, h must be aligned on a 64-byte boundary
+	size_t iw = WidthIndex(hw);
+	CheckSIMDVersion(SIMDversion);
+	if( SIMDversion == IS_AVX512 )
+		shared512_table[iw]((const v16si*)data, nblocks, m, (v16si*)h);
+	else if( SIMDversion == IS_AVX2 )
+		shared256_table[iw]((const v8si*)data, nblocks, m, (v8si*)h);
+	else if( SIMDversion == IS_SSE2 )
+		shared128_table[iw]((const v4si*)data, nblocks, m, (v4si*)h);
 	else
-	{
-		cout << "Internal error: impossible value for rounded hash width: " << rhw << "." << endl;
-		exit(1);
-	}
+		shared32_table[iw]((const uint32_t*)data, nblocks, m, h);
 }
 
-static void VectorHash512(const void* buf, size_t len, uint32_t seed, void* out, size_t hw)
+void VectorHashFinalize(size_t len, uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[], void* out,
+						is_type SIMDversion, size_t hw)
 {
-	uint32_t rhw =  pow2roundup(hw);
-	if( rhw == 32 )
-		VectorHash512_32(buf, len, seed, out, hw);
-	else if( rhw == 64 )
-		VectorHash512_64(buf, len, seed, out, hw);
-	else if( rhw == 128 )
-		VectorHash512_128(buf, len, seed, out, hw);
-	else if( rhw == 256 )
-		VectorHash512_256(buf, len, seed, out, hw);
-	else if( rhw == 512 )
-		VectorHash512_512(buf, len, seed, out, hw);
-	else if( rhw == 1024 )
-		VectorHash512_1024(buf, len, seed, out, hw);
+	// all versions give identical results, h1 .. h4 are overwritten and must be aligned on a 64-byte boundary
+	size_t iw = WidthIndex(hw);
+	CheckSIMDVersion(SIMDversion);
+	if( SIMDversion == IS_AVX512 )
+		finalize512_table[iw](len, (v16si*)h1, (v16si*)h2, (v16si*)h3, (v16si*)h4, out, hw);
+	else if( SIMDversion == IS_AVX2 )
+		finalize256_table[iw](len, (v8si*)h1, (v8si*)h2, (v8si*)h3, (v8si*)h4, out, hw);
+	else if( SIMDversion == IS_SSE2 )
+		finalize128_table[iw](len, (v4si*)h1, (v4si*)h2, (v4si*)h3, (v4si*)h4, out, hw);
 	else
-	{
-		cout << "Internal error: impossible value for rounded hash width: " << rhw << "." << endl;
-		exit(1);
-	}
+		finalize32_table[iw](len, h1, h2, h3, h4, out, hw);
 }
 
 void VectorHash(const void* buf, size_t len, uint32_t seed, void* out, is_type SIMDversion, size_t hw)
 {
-	auto ibuf = reinterpret_cast<uintptr>(buf);
-	// check if the alignment of the pointer in buf is OK
-	// AVX512 requires 64-byte alignment
-	// AVX2   requires 32-byte alignment
-	// SSE2   requires 16-byte alignment
-	// Scalar requires no special alignment
-	if( SIMDversion >= IS_AVX512 && (ibuf&0x3f) == 0 )
-	{
-		VectorHash512(buf, len, seed, out, hw);
-	}
-	else if( SIMDversion >= IS_AVX2 && (ibuf&0x1f) == 0 )
-	{
-		VectorHash256(buf, len, seed, out, hw);
-	}
-	else if( SIMDversion >= IS_SSE2 && (ibuf&0x0f) == 0 )
-	{
-		VectorHash128(buf, len, seed, out, hw);
-	}
-	else if( SIMDversion >= IS_SCALAR )
-	{
-		VectorHash32(buf, len, seed, out, hw);
-	}
-	else
-	{
-		cout << "Internal error: impossible value for SIMD version: " << SIMDversion << "." << endl;
-		exit(1);
-	}
+	CheckSIMDVersion(SIMDversion);
+	hash_table[SIMDversion][WidthIndex(hw)](buf, len, seed, out, hw);
 }
 
 void VectorHash(const void* buf, size_t len, uint32_t seed, void* out, size_t hw)
 {
-	VectorHash(buf, len, seed, out, GetSIMDVersion(), hw);
+	VectorHash(buf, len, seed, out, GetCachedSIMDVersion(), hw);
+}
+
+// checksums of n independent buffers, the dispatch is done once for the whole batch
+// the results are stored back to back in outs, each taking hw/8 bytes
+void VectorHashBatch(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed, void* outs,
+					 is_type SIMDversion, size_t hw)
+{
+	CheckSIMDVersion(SIMDversion);
+	batch_table[SIMDversion][WidthIndex(hw)](bufs, lens, n, seed, outs, hw);
+}
+
+void VectorHashBatch(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed, void* outs, size_t hw)
+{
+	VectorHashBatch(bufs, lens, n, seed, outs, GetCachedSIMDVersion(), hw);
+}
+
+vh_impl VectorHashGetImpl(size_t hw)
+{
+	if( hw < 32 || hw > 1024 || (hw & size_t{0x1f}) != 0 )
+		return NULL;
+	return hash_table[GetCachedSIMDVersion()][WidthIndex(hw)];
 }
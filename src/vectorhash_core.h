@@ -11,6 +11,9 @@
 #define VECTORHASH_CORE_H
 
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "vectorhash.h"
 #include "vectorhash_priv.h"
 #include "vectorhash_avx512.h"
 #include "vectorhash_avx2.h"
@@ -19,12 +22,41 @@
 
 void stateinit(uint32_t st[], uint32_t& seed, size_t lvh_nint);
 is_type GetSIMDVersion();
+is_type GetCachedSIMDVersion();
 void VectorHashBody32(const uint32_t* data, uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[],
 					  size_t hash_width);
 void VectorHashBody128(const v4si* data, v4si h1[], v4si h2[], v4si h3[], v4si h4[], size_t hash_width);
 void VectorHashBody256(const v8si* data, v8si h1[], v8si h2[], v8si h3[], v8si h4[], size_t hash_width);
 void VectorHashBody512(const v16si* data, v16si h1[], v16si h2[], v16si h3[], v16si h4[], size_t hash_width);
+void VectorHashBlocks(const void* data, size_t nblocks, uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[],
+					  is_type SIMDversion, size_t hash_width);
+void VectorHashLanes(const void* data, size_t nblocks, size_t lane0, size_t nlanes,
+					 uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[], is_type SIMDversion, size_t hash_width);
+void VectorHashShared(const void* data, size_t nblocks, size_t m, uint32_t h[], is_type SIMDversion,
+					  size_t hash_width);
+void VectorHashFinalize(size_t len, uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[], void* out,
+						is_type SIMDversion, size_t hash_width);
 void VectorHash(const void* buf, size_t len, uint32_t seed, void* out, is_type SIMDversion, size_t hash_width);
+void VectorHashInit(vh_state* state, uint32_t seed, is_type SIMDversion, size_t hash_width);
+#ifndef _MSC_VER
+void VectorHashV(const struct iovec* iov, int iovcnt, uint32_t seed, void* out, is_type SIMDversion,
+				 size_t hash_width);
+#endif
+void VectorHashMulti(const void* buf, size_t len, uint32_t seed, void* outs, is_type SIMDversion,
+					 const size_t hash_widths[], size_t n);
+void VectorHashMultiSeed(const void* buf, size_t len, const uint32_t seeds[], size_t n, void* outs,
+						 is_type SIMDversion, size_t hash_width);
+void VectorHashUpdate(vh_state* state, const void* buf, size_t len, size_t nthreads);
+void VectorHashTree(const void* buf, size_t len, uint32_t seed, void* out, is_type SIMDversion, size_t hash_width,
+					size_t chunksize, size_t nthreads);
+void VectorHashTreeHashLeaves(const void* buf, size_t len, uint32_t seed, void* leaves, is_type SIMDversion,
+							  size_t hash_width, size_t chunksize, size_t nthreads);
+void VectorHashTreeRoot(const void* leaves, size_t nleaves, uint64_t len, uint32_t seed, void* out,
+						is_type SIMDversion, size_t hash_width, size_t chunksize);
+void VectorHashParallel(const void* buf, size_t len, uint32_t seed, void* out, is_type SIMDversion,
+						size_t hash_width, size_t nthreads);
+void VectorHashBatch(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed, void* outs,
+					 is_type SIMDversion, size_t hash_width);
 
 // This routine is needed because the standard says that integer overflow results in undefined behavior.
 // This routine looks like a lot of overhead, but a good compiler will optimize this into a single
@@ -55,4 +87,43 @@ inline uint32_t pow2roundup(uint32_t x)
     return x+1;
 }
 
+// the largest number of uint32_t's in a state vector (for a 1024-bit checksum)
+static const size_t vh_max_nint = 2*1024/32;
+
+// the state vectors need to be aligned for the SIMD routines, the vh_state struct
+// however may be anywhere in memory, so we work on an aligned copy of the state
+struct vh_lanes
+{
+	alignas(64) uint32_t h[4][vh_max_nint];
+	void load(const vh_state* state, size_t nint)
+	{
+		for( size_t i=0; i < 4; i++ )
+			memcpy( h[i], state->h[i], nint*sizeof(uint32_t) );
+	}
+	void store(vh_state* state, size_t nint) const
+	{
+		for( size_t i=0; i < 4; i++ )
+			memcpy( state->h[i], h[i], nint*sizeof(uint32_t) );
+	}
+};
+
+// number of uint32_t's in each of the state vectors h1..h4 for a given checksum width
+inline size_t nint_for_width(size_t hw)
+{
+	size_t vh_virtreg_width = max(2*size_t(pow2roundup(hw)), vh_hwreg_width);
+	return vh_virtreg_width/32;
+}
+
+// the number of bytes that are processed in a single call to VectorHashBody
+inline size_t blocksize_for_width(size_t hw)
+{
+	return 4*nint_for_width(hw)*sizeof(uint32_t);
+}
+
+// the number of uint32_t lanes in a single hardware register
+inline size_t lanes_per_register(is_type SIMDversion)
+{
+	return ( SIMDversion == IS_AVX512 ) ? 16 : ( SIMDversion == IS_AVX2 ) ? 8 : ( SIMDversion == IS_SSE2 ) ? 4 : 1;
+}
+
 #endif
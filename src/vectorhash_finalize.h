@@ -10,6 +10,10 @@
 #ifndef VECTORHASH_FINALIZE_H
 #define VECTORHASH_FINALIZE_H
 
+#include <iostream>
+#include "vectorhash_priv.h"
+#include "vectorhash_core.h"
+
 void VectorHashFinalize_32(size_t len, uint32_t* h1, uint32_t* h2, uint32_t* h3, uint32_t* h4, void* out, size_t hw);
 void VectorHashFinalize_64(size_t len, uint32_t* h1, uint32_t* h2, uint32_t* h3, uint32_t* h4, void* out, size_t hw);
 void VectorHashFinalize_128(size_t len, uint32_t* h1, uint32_t* h2, uint32_t* h3, uint32_t* h4, void* out, size_t hw);
@@ -17,4 +21,56 @@ void VectorHashFinalize_256(size_t len, uint32_t* h1, uint32_t* h2, uint32_t* h3
 void VectorHashFinalize_512(size_t len, uint32_t* h1, uint32_t* h2, uint32_t* h3, uint32_t* h4, void* out, size_t hw);
 void VectorHashFinalize_1024(size_t len, uint32_t* h1, uint32_t* h2, uint32_t* h3, uint32_t* h4, void* out, size_t hw);
 
+//-----------------------------------------------------------------------------
+// Helper routines for the last step of the finalization, these are shared by the
+// scalar and the SIMD versions of VectorHashFinalize. The state h1 | h2 | h3 | h4
+// (4*vh_nint words) is split into vh_nfold chunks of vh_nchunk words each. Every
+// word is mixed with the word at the mirrored position in the chunk half a state
+// further on (i.e. h1 with h3 and h2 with h4), giving Y = fmix32(H[k] ^ H[m(k)]).
+// Folded word i is then the XOR of Y over the diagonal starting at chunk i.
+
+static const size_t vh_nfold = ( vh_nstate > 4 ) ? vh_nstate : 4;
+static const size_t vh_nchunk = 4*vh_nint/vh_nfold;
+
+// the mirrored position of word j within its chunk, vh_nchunk is a power of 2
+inline size_t vh_mirror(size_t j)
+{
+	return j ^ (vh_nchunk-1);
+}
+
+// fold Y (see above) into vh_nfold words, reduce those to the hash width and store the result
+inline void vh_fold_finish(const uint32_t Y[], void* out, size_t hw)
+{
+	uint32_t lres[vh_nfold];
+	for( size_t i=0; i < vh_nfold; i++ )
+		lres[i] = Y[i*vh_nchunk];
+	for( size_t j=1; j < vh_nchunk; j++ )
+		for( size_t i=0; i < vh_nfold; i++ )
+			lres[i] ^= Y[((i+j)%vh_nfold)*vh_nchunk+j];
+
+	size_t ns = vh_nfold;
+	while( ns > vh_nstate )
+	{
+		for( size_t i=0; i < ns/2; ++i )
+			lres[i] = fmix32(lres[i], lres[ns-1-i]);
+		ns /= 2;
+	}
+
+	size_t nw = hw/32;
+	if( nw < vh_nstate )
+	{
+		if( nw < vh_nstate/2 )
+		{
+			std::cerr << "Internal error: impossible value for hash width\n";
+			exit(1);
+		}
+		for( size_t i=0; i < nw; ++i )
+			lres[i] = fmix32(lres[i], lres[i+vh_nstate-nw]);
+	}
+
+	uint32_t* res = (uint32_t*)out;
+	for( size_t i=0; i < nw; i++ )
+		res[i] = lres[i];
+}
+
 #endif
@@ -0,0 +1,140 @@
+//-------------------------------------------------------------------------------
+//  VectorHash - a very fast hash function optimized using SIMD instructions
+//
+//  Copyright (c) 2018-2025 Peter A.M. van Hoof
+//  All Rights Reserved
+//
+//  Distributed under the "zlib license". See the accompanying LICENSE file.
+//-------------------------------------------------------------------------------
+
+#include <cstring>
+#include <thread>
+#include <system_error>
+#include <vector>
+#include "vectorhash.h"
+#include "vectorhash_priv.h"
+#include "vectorhash_core.h"
+
+//-----------------------------------------------------------------------------
+// Multi-threaded version of VectorHash. Lane j of the state vectors h1..h4 only
+// ever uses word j of each quarter block, so until the finalization step the
+// virtual register consists of fully independent streams. Each thread reads the
+// whole buffer, but only updates a subset of the lanes. The result is identical
+// to the single-threaded version.
+
+// below this size the overhead of starting the threads is not recovered
+static const size_t vh_parallel_min = size_t(1) << 20;
+
+static void LaneWorker(const void* buf, size_t nblocks, size_t lane0, size_t nlanes,
+					   uint32_t (*h)[vh_max_nint], is_type SIMDversion, size_t hw)
+{
+	alignas(64) uint32_t z[4][vh_max_nint];
+	for( size_t i=0; i < 4; i++ )
+		memcpy( z[i], &h[i][lane0], nlanes*sizeof(uint32_t) );
+	VectorHashLanes( buf, nblocks, lane0, nlanes, z[0], z[1], z[2], z[3], SIMDversion, hw );
+	for( size_t i=0; i < 4; i++ )
+		memcpy( &h[i][lane0], z[i], nlanes*sizeof(uint32_t) );
+}
+
+// process nblocks complete blocks using up to nthreads threads, each thread gets at least one register
+// a narrower instruction set would allow more threads, but each thread still reads the whole buffer,
+// so the total amount of work would grow with the number of threads and nothing would be gained
+static void ParallelBlocks(const void* buf, size_t nblocks, uint32_t (*h)[vh_max_nint], is_type SIMDversion,
+						   size_t hw, size_t nthreads)
+{
+	size_t nint = nint_for_width(hw);
+	size_t nl = lanes_per_register(SIMDversion);
+	size_t nreg = nint/nl;
+	size_t nworker = min(nthreads, nreg);
+	if( nworker <= 1 )
+	{
+		VectorHashBlocks( buf, nblocks, h[0], h[1], h[2], h[3], SIMDversion, hw );
+		return;
+	}
+
+	// distribute the registers as evenly as possible over the threads
+	vector<thread> workers;
+	size_t r0 = 0;
+	for( size_t w=0; w < nworker; w++ )
+	{
+		size_t nr = nreg/nworker + ( w < nreg%nworker ? 1 : 0 );
+		try
+		{
+			workers.emplace_back( LaneWorker, buf, nblocks, r0*nl, nr*nl, h, SIMDversion, hw );
+		}
+		catch( const system_error& )
+		{
+			// we could not start a new thread, so do the work ourselves
+			LaneWorker( buf, nblocks, r0*nl, nr*nl, h, SIMDversion, hw );
+		}
+		r0 += nr;
+	}
+	for( auto& w : workers )
+		w.join();
+}
+
+void VectorHashParallel(const void* buf, size_t len, uint32_t seed, void* out, is_type SIMDversion, size_t hw,
+						size_t nthreads)
+{
+	if( nthreads == 0 )
+		nthreads = max(thread::hardware_concurrency(), 1u);
+
+	if( nthreads == 1 || len < vh_parallel_min )
+	{
+		VectorHash(buf, len, seed, out, SIMDversion, hw);
+		return;
+	}
+
+	size_t nint = nint_for_width(hw);
+	size_t bs = blocksize_for_width(hw);
+	alignas(64) uint32_t h[4][vh_max_nint];
+	for( size_t i=0; i < 4; i++ )
+		stateinit( h[i], seed, nint );
+
+	size_t nblocks = len/bs;
+	ParallelBlocks( buf, nblocks, h, SIMDversion, hw, nthreads );
+
+	// pad the remaining characters and process...
+	alignas(64) uint8_t block[4*vh_max_nint*sizeof(uint32_t)];
+	pad_buffer( (const uint8_t*)buf + nblocks*bs, block, len-nblocks*bs, bs );
+	VectorHashBlocks( block, 1, h[0], h[1], h[2], h[3], SIMDversion, hw );
+
+	VectorHashFinalize( len, h[0], h[1], h[2], h[3], out, SIMDversion, hw );
+}
+
+// multi-threaded version of VectorHashUpdate, the state is identical to the single-threaded version
+void VectorHashUpdate(vh_state* state, const void* buf, size_t len, size_t nthreads)
+{
+	if( nthreads == 0 )
+		nthreads = max(thread::hardware_concurrency(), 1u);
+
+	size_t hw = state->hash_width;
+	size_t bs = blocksize_for_width(hw);
+	const uint8_t* data = (const uint8_t*)buf;
+
+	// first complete a partial block left over from the previous call
+	size_t n0 = ( state->ntail > 0 ) ? min(len, bs - state->ntail) : 0;
+	VectorHashUpdate( state, data, n0 );
+	data += n0;
+	len -= n0;
+
+	size_t nblocks = len/bs;
+	if( nthreads > 1 && len >= vh_parallel_min && state->ntail == 0 )
+	{
+		size_t nint = nint_for_width(hw);
+		vh_lanes z;
+		z.load( state, nint );
+		ParallelBlocks( data, nblocks, z.h, is_type(state->simd), hw, nthreads );
+		z.store( state, nint );
+		state->len += nblocks*bs;
+		data += nblocks*bs;
+		len -= nblocks*bs;
+	}
+
+	VectorHashUpdate( state, data, len );
+}
+
+void VectorHashParallel(const void* buf, size_t len, uint32_t seed, void* out, size_t hw, size_t nthreads)
+{
+	VectorHashParallel(buf, len, seed, out, GetCachedSIMDVersion(), hw, nthreads);
+}
@@ -13,6 +13,7 @@
 #include <string>
 #include <type_traits>
 #include <cstdlib>
+#include <cstring>
 #include <cstdint>
 
 using namespace std;
@@ -65,6 +66,18 @@ static const size_t vh_hash_width = 32;
 // width of largest hardware register that is supported (in bits)
 static const size_t vh_hwreg_width = 512;
 
+// buffers of at least this size (in bytes) are read using software prefetching,
+// smaller buffers are likely to be in the CPU cache already
+static const size_t vh_prefetch_min = size_t(1) << 20;
+// the default distance (in bytes) at which the data is prefetched, this can be
+// changed at run time with VectorHashSetPrefetch()
+static const size_t vh_prefetch_default = 4096;
+// the size of a cache line (in bytes)
+static const size_t vh_cacheline = 64;
+// the largest number of independent messages that are advanced in lockstep by
+// the interleaved kernels (VectorHashInterleave)
+static const size_t vh_max_interleave = 4;
+
 //-----------------------------------------------------------------------------
 // derived quantities
 
@@ -107,14 +120,15 @@ inline uint32_t rotl32 ( uint32_t x, int r )
 
 #endif
 
+// the padding bytes 1, 2, 3, ..., 255, 0, 1, ... for the longest possible block (1024 bytes), they are
+// preceded by vh_cacheline zero bytes so that a register can be loaded from just in front of the pattern
+extern const uint8_t vh_pad_table[];
+static const uint8_t* const vh_pad_pattern = vh_pad_table + vh_cacheline;
+
 inline void pad_buffer(const uint8_t* src, uint8_t* buf, size_t len, size_t bufsz)
 {
-	for( size_t i=0; i < len; i++ )
-		buf[i] = src[i];
-	uint32_t c = 0;
-	const uint32_t mask = 0xff;
-	while( len < bufsz )
-		buf[len++] = uint8_t(++c & mask);
+	memcpy( buf, src, len );
+	memcpy( buf+len, vh_pad_pattern, bufsz-len );
 }
 
 //-----------------------------------------------------------------------------
@@ -133,4 +147,65 @@ inline uint32_t getblock32 ( uint32_t p )
 
 #define VEC(N, X) for( size_t j=0; j < (N); j++ ) { X; }
 
+//-----------------------------------------------------------------------------
+// Little-endian storage - data that leave the library (tree nodes, saved states)
+// must be platform independent
+
+inline void store_words(uint8_t* p, const uint32_t* w, size_t nw)
+{
+	for( size_t i=0; i < nw; i++ )
+		for( size_t k=0; k < 4; k++ )
+			*p++ = uint8_t(w[i] >> 8*k);
+}
+
+inline void store_uint64(uint8_t* p, uint64_t x)
+{
+	for( size_t k=0; k < 8; k++ )
+		*p++ = uint8_t(x >> 8*k);
+}
+
+inline void load_words(const uint8_t* p, uint32_t* w, size_t nw)
+{
+	for( size_t i=0; i < nw; i++ )
+	{
+		w[i] = 0;
+		for( size_t k=0; k < 4; k++ )
+			w[i] |= uint32_t(*p++) << 8*k;
+	}
+}
+
+inline uint64_t load_uint64(const uint8_t* p)
+{
+	uint64_t x = 0;
+	for( size_t k=0; k < 8; k++ )
+		x |= uint64_t(*p++) << 8*k;
+	return x;
+}
+
+//-----------------------------------------------------------------------------
+// Software prefetching - ask the CPU to start loading the data of a block that
+// will be processed later, this hides part of the memory latency for buffers
+// that do not fit in the cache
+
+inline void vh_prefetch(const void* p)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch( p, 0, 3 );
+#else
+	(void)p;
+#endif
+}
+
+// prefetch the bs bytes starting at p, one cache line at a time
+inline void prefetch_block(const void* p, size_t bs)
+{
+	const char* c = (const char*)p;
+	for( size_t k=0; k < bs; k += vh_cacheline )
+		vh_prefetch( c + k );
+}
+
+// the number of blocks (out of len/bs) that can be processed while prefetching
+// dist bytes ahead without reading beyond the buffer, 0 if prefetching is not used
+size_t PrefetchBlocks(size_t len, size_t bs, size_t& dist);
+
 #endif
@@ -12,7 +12,7 @@
 #include "vectorhash_finalize.h"
 #include "vectorhash_scalar.h"
 
-void EXT(VectorHashBody32)(const uint32_t* data, uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[])
+static inline void vh_body32(const uint32_t* data, uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[])
 {
 	uint32_t s[vh_nint];
 
@@ -33,21 +33,77 @@ void EXT(VectorHashBody32)(const uint32_t* data, uint32_t h1[], uint32_t h2[], u
 	VEC( vh_nint, h1[j] = ROTL32(s[j], 19) );
 }
 
-void EXT(VectorHash32)(const void* buffer, size_t len, uint32_t seed, void* out, size_t hw)
+void EXT(VectorHashBody32)(const uint32_t* data, uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[])
 {
-	uint32_t h1[vh_nint], h2[vh_nint], h3[vh_nint], h4[vh_nint];
-	stateinit( h1, seed, vh_nint );
-	stateinit( h2, seed, vh_nint );
-	stateinit( h3, seed, vh_nint );
-	stateinit( h4, seed, vh_nint );
+	vh_body32(data, h1, h2, h3, h4);
+}
 
-	size_t nblocks = len/blocksize;
-	const uint32_t* data = (const uint32_t*)buffer;
+// process nblocks consecutive blocks, the state vectors are too large to be kept in registers
+// here, but operating on them in place lets the compiler vectorize the body
+void EXT(VectorHashBlocks32)(const uint32_t* data, size_t nblocks,
+							 uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[])
+{
+	size_t pfd;
+	size_t npf = PrefetchBlocks( nblocks*blocksize, blocksize, pfd );
 	for( size_t i=0; i < nblocks; i++ )
 	{
-		EXT(VectorHashBody32)(data, h1, h2, h3, h4);
+		if( i < npf )
+			prefetch_block( (const uint8_t*)data + pfd, blocksize );
+		vh_body32(data, h1, h2, h3, h4);
 		data += 4*vh_nint;
 	}
+}
+
+// a single step of the body for one lane, ha and hb are two consecutive state vectors
+static inline void vh_step32(uint32_t& ha, uint32_t& hb, const uint32_t* data)
+{
+	uint32_t s = ha ^ hb ^ getblock32( *data );
+	ha = ROTL32(ha, 11) ^ s ^ (s << 14);
+	hb = ROTL32(s, 19);
+}
+
+// process nblocks blocks, but only for lanes r0 .. r0+nr-1 of the virtual register
+// h1 .. h4 hold only those nr lanes, this works because all lanes are independent
+void EXT(VectorHashLanes32)(const uint32_t* data, size_t nblocks, size_t r0, size_t nr,
+							uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[])
+{
+	data += r0;
+	for( size_t i=0; i < nblocks; i++ )
+	{
+		for( size_t j=0; j < nr; j++ )
+		{
+			vh_step32(h1[j], h2[j], data + j);
+			vh_step32(h2[j], h3[j], data + vh_nint + j);
+			vh_step32(h3[j], h4[j], data + 2*vh_nint + j);
+			vh_step32(h4[j], h1[j], data + 3*vh_nint + j);
+		}
+		data += 4*vh_nint;
+	}
+}
+
+// process nblocks blocks of the same data for m state sets, the state of set k is stored in h[4*vh_nint*k]
+// onwards, each block is processed for all sets before moving on, so that it is still in the cache
+void EXT(VectorHashShared32)(const uint32_t* data, size_t nblocks, size_t m, uint32_t h[])
+{
+	for( size_t i=0; i < nblocks; i++ )
+	{
+		for( size_t k=0; k < m; k++ )
+		{
+			uint32_t* hk = h + 4*vh_nint*k;
+			vh_body32(data, hk, hk+vh_nint, hk+2*vh_nint, hk+3*vh_nint);
+		}
+		data += 4*vh_nint;
+	}
+}
+
+// checksum of a single buffer, h1 .. h4 must hold the initial state on entry
+static inline void vh_hash32(const void* buffer, size_t len, uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[],
+							 void* out, size_t hw)
+{
+	size_t nblocks = len/blocksize;
+	const uint32_t* data = (const uint32_t*)buffer;
+	EXT(VectorHashBlocks32)(data, nblocks, h1, h2, h3, h4);
+	data += nblocks*4*vh_nint;
 
 	// pad the remaining characters and process...
 	uint32_t buf[blocksize/sizeof(uint32_t)];
@@ -56,3 +112,35 @@ void EXT(VectorHash32)(const void* buffer, size_t len, uint32_t seed, void* out,
 
 	EXT(VectorHashFinalize)(len, h1, h2, h3, h4, out, hw);
 }
+
+void EXT(VectorHash32)(const void* buffer, size_t len, uint32_t seed, void* out, size_t hw)
+{
+	uint32_t h1[vh_nint], h2[vh_nint], h3[vh_nint], h4[vh_nint];
+	stateinit( h1, seed, vh_nint );
+	stateinit( h2, seed, vh_nint );
+	stateinit( h3, seed, vh_nint );
+	stateinit( h4, seed, vh_nint );
+	vh_hash32(buffer, len, h1, h2, h3, h4, out, hw);
+}
+
+// checksums of n independent buffers with the same seed, the initial state is only calculated once
+void EXT(VectorHashBatch32)(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed, void* outs,
+							size_t hw)
+{
+	uint32_t z1[vh_nint], z2[vh_nint], z3[vh_nint], z4[vh_nint];
+	stateinit( z1, seed, vh_nint );
+	stateinit( z2, seed, vh_nint );
+	stateinit( z3, seed, vh_nint );
+	stateinit( z4, seed, vh_nint );
+
+	uint8_t* out = (uint8_t*)outs;
+	for( size_t k=0; k < n; k++ )
+	{
+		uint32_t h1[vh_nint], h2[vh_nint], h3[vh_nint], h4[vh_nint];
+		VEC( vh_nint, h1[j] = z1[j] );
+		VEC( vh_nint, h2[j] = z2[j] );
+		VEC( vh_nint, h3[j] = z3[j] );
+		VEC( vh_nint, h4[j] = z4[j] );
+		vh_hash32(bufs[k], lens[k], h1, h2, h3, h4, out + k*(hw/8), hw);
+	}
+}
@@ -19,6 +19,39 @@ void VectorHashBody32_256(const uint32_t* data, uint32_t h1[], uint32_t h2[], ui
 void VectorHashBody32_512(const uint32_t* data, uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
 void VectorHashBody32_1024(const uint32_t* data, uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
 
+void VectorHashBlocks32_32(const uint32_t* data, size_t nblocks,
+						   uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
+void VectorHashBlocks32_64(const uint32_t* data, size_t nblocks,
+						   uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
+void VectorHashBlocks32_128(const uint32_t* data, size_t nblocks,
+						   uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
+void VectorHashBlocks32_256(const uint32_t* data, size_t nblocks,
+						   uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
+void VectorHashBlocks32_512(const uint32_t* data, size_t nblocks,
+						   uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
+void VectorHashBlocks32_1024(const uint32_t* data, size_t nblocks,
+						   uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
+
+void VectorHashLanes32_32(const uint32_t* data, size_t nblocks, size_t r0, size_t nr,
+						  uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
+void VectorHashLanes32_64(const uint32_t* data, size_t nblocks, size_t r0, size_t nr,
+						  uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
+void VectorHashLanes32_128(const uint32_t* data, size_t nblocks, size_t r0, size_t nr,
+						  uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
+void VectorHashLanes32_256(const uint32_t* data, size_t nblocks, size_t r0, size_t nr,
+						  uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
+void VectorHashLanes32_512(const uint32_t* data, size_t nblocks, size_t r0, size_t nr,
+						  uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
+void VectorHashLanes32_1024(const uint32_t* data, size_t nblocks, size_t r0, size_t nr,
+						  uint32_t h1[], uint32_t h2[], uint32_t h3[], uint32_t h4[]);
+
+void VectorHashShared32_32(const uint32_t* data, size_t nblocks, size_t m, uint32_t h[]);
+void VectorHashShared32_64(const uint32_t* data, size_t nblocks, size_t m, uint32_t h[]);
+void VectorHashShared32_128(const uint32_t* data, size_t nblocks, size_t m, uint32_t h[]);
+void VectorHashShared32_256(const uint32_t* data, size_t nblocks, size_t m, uint32_t h[]);
+void VectorHashShared32_512(const uint32_t* data, size_t nblocks, size_t m, uint32_t h[]);
+void VectorHashShared32_1024(const uint32_t* data, size_t nblocks, size_t m, uint32_t h[]);
+
 void VectorHash32_32(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 void VectorHash32_64(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 void VectorHash32_128(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
@@ -26,4 +59,17 @@ void VectorHash32_256(const void* buf, size_t len, uint32_t seed, void* out, siz
 void VectorHash32_512(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 void VectorHash32_1024(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 
+void VectorHashBatch32_32(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+						  void* outs, size_t hw);
+void VectorHashBatch32_64(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+						  void* outs, size_t hw);
+void VectorHashBatch32_128(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+						   void* outs, size_t hw);
+void VectorHashBatch32_256(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+						   void* outs, size_t hw);
+void VectorHashBatch32_512(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+						   void* outs, size_t hw);
+void VectorHashBatch32_1024(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+							void* outs, size_t hw);
+
 #endif
@@ -16,14 +16,19 @@
 // Platform-specific functions and macros
 
 static const size_t nreg128 = vh_nint/4;
+// the number of messages that VectorHashBatch advances in lockstep, this only pays off when the state
+// of a message takes at most two registers, otherwise there is enough parallelism and we run out of registers
+static const size_t ninter128 = ( nreg128 <= 2 ) ? 2 : 1;
+// the number of state sets that VectorHashShared advances together, these need to fit in the registers
+static const size_t nshared128 = ( nreg128 < vh_max_interleave ) ? vh_max_interleave/nreg128 : 1;
 
 #ifdef VH_INTEL
-void EXT(VectorHashBody128)(const v4si* data, v4si h1[], v4si h2[], v4si h3[], v4si h4[])
+static inline void vh_body128(const v4si* data, v4si h1[], v4si h2[], v4si h3[], v4si h4[])
 {
 	v4si s[nreg128], x1[nreg128], x2[nreg128];
 
 	VEC( nreg128, s[j] = _mm_xor_si128(h1[j], h2[j]) );
-	VEC( nreg128, s[j] = _mm_xor_si128(s[j], *data++) );
+	VEC( nreg128, s[j] = _mm_xor_si128(s[j], _mm_loadu_si128(data++)) );
 	VEC( nreg128, x1[j] = _mm_slli_epi32(h1[j], 11) );
 	VEC( nreg128, x2[j] = _mm_srli_epi32(h1[j], 21) );
 	VEC( nreg128, x1[j] = _mm_or_si128(x1[j], x2[j]) );
@@ -35,7 +40,7 @@ void EXT(VectorHashBody128)(const v4si* data, v4si h1[], v4si h2[], v4si h3[], v
 	VEC( nreg128, h2[j] = _mm_or_si128(x1[j], x2[j]) );
 
 	VEC( nreg128, s[j] = _mm_xor_si128(h2[j], h3[j]) );
-	VEC( nreg128, s[j] = _mm_xor_si128(s[j], *data++) );
+	VEC( nreg128, s[j] = _mm_xor_si128(s[j], _mm_loadu_si128(data++)) );
 	VEC( nreg128, x1[j] = _mm_slli_epi32(h2[j], 11) );
 	VEC( nreg128, x2[j] = _mm_srli_epi32(h2[j], 21) );
 	VEC( nreg128, x1[j] = _mm_or_si128(x1[j], x2[j]) );
@@ -47,7 +52,7 @@ void EXT(VectorHashBody128)(const v4si* data, v4si h1[], v4si h2[], v4si h3[], v
 	VEC( nreg128, h3[j] = _mm_or_si128(x1[j], x2[j]) );
 
 	VEC( nreg128, s[j] = _mm_xor_si128(h3[j], h4[j]) );
-	VEC( nreg128, s[j] = _mm_xor_si128(s[j], *data++) );
+	VEC( nreg128, s[j] = _mm_xor_si128(s[j], _mm_loadu_si128(data++)) );
 	VEC( nreg128, x1[j] = _mm_slli_epi32(h3[j], 11) );
 	VEC( nreg128, x2[j] = _mm_srli_epi32(h3[j], 21) );
 	VEC( nreg128, x1[j] = _mm_or_si128(x1[j], x2[j]) );
@@ -59,7 +64,7 @@ void EXT(VectorHashBody128)(const v4si* data, v4si h1[], v4si h2[], v4si h3[], v
 	VEC( nreg128, h4[j] = _mm_or_si128(x1[j], x2[j]) );
 
 	VEC( nreg128, s[j] = _mm_xor_si128(h4[j], h1[j]) );
-	VEC( nreg128, s[j] = _mm_xor_si128(s[j], *data++) );
+	VEC( nreg128, s[j] = _mm_xor_si128(s[j], _mm_loadu_si128(data++)) );
 	VEC( nreg128, x1[j] = _mm_slli_epi32(h4[j], 11) );
 	VEC( nreg128, x2[j] = _mm_srli_epi32(h4[j], 21) );
 	VEC( nreg128, x1[j] = _mm_or_si128(x1[j], x2[j]) );
@@ -70,37 +75,445 @@ void EXT(VectorHashBody128)(const v4si* data, v4si h1[], v4si h2[], v4si h3[], v
 	VEC( nreg128, x2[j] = _mm_srli_epi32(s[j], 13) );
 	VEC( nreg128, h1[j] = _mm_or_si128(x1[j], x2[j]) );
 }
-#else
-void EXT(VectorHashBody128)(const v4si*, v4si[], v4si[], v4si[], v4si[])
+
+void EXT(VectorHashBody128)(const v4si* data, v4si h1[], v4si h2[], v4si h3[], v4si h4[])
 {
-	(void)0;
+	vh_body128(data, h1, h2, h3, h4);
 }
-#endif
 
-void EXT(VectorHash128)(const void* buffer, size_t len, uint32_t seed, void* out, size_t hw)
+// process nblocks consecutive blocks, the state is copied into local variables so that it can
+// be kept in registers for the whole loop instead of being stored and reloaded for every block
+void EXT(VectorHashBlocks128)(const v4si* data, size_t nblocks,
+							  v4si h1[], v4si h2[], v4si h3[], v4si h4[])
 {
-	v4si h1[nreg128], h2[nreg128], h3[nreg128], h4[nreg128];
-	stateinit( (uint32_t*)h1, seed, vh_nint );
-	stateinit( (uint32_t*)h2, seed, vh_nint );
-	stateinit( (uint32_t*)h3, seed, vh_nint );
-	stateinit( (uint32_t*)h4, seed, vh_nint );
+	v4si z1[nreg128], z2[nreg128], z3[nreg128], z4[nreg128];
+	VEC( nreg128, z1[j] = h1[j] );
+	VEC( nreg128, z2[j] = h2[j] );
+	VEC( nreg128, z3[j] = h3[j] );
+	VEC( nreg128, z4[j] = h4[j] );
+
+	size_t pfd;
+	size_t npf = PrefetchBlocks( nblocks*blocksize, blocksize, pfd );
+	for( size_t i=0; i < nblocks; i++ )
+	{
+		if( i < npf )
+			prefetch_block( (const uint8_t*)data + pfd, blocksize );
+		vh_body128(data, z1, z2, z3, z4);
+		data += 4*nreg128;
+	}
+
+	VEC( nreg128, h1[j] = z1[j] );
+	VEC( nreg128, h2[j] = z2[j] );
+	VEC( nreg128, h3[j] = z3[j] );
+	VEC( nreg128, h4[j] = z4[j] );
+}
+
+// a single step of the body for one register, ha and hb are two consecutive state vectors
+static inline void vh_step128(v4si& ha, v4si& hb, v4si d)
+{
+	v4si s = _mm_xor_si128(ha, hb);
+	s = _mm_xor_si128(s, d);
+	v4si x1 = _mm_slli_epi32(ha, 11);
+	v4si x2 = _mm_srli_epi32(ha, 21);
+	x1 = _mm_or_si128(x1, x2);
+	x1 = _mm_xor_si128(x1, s);
+	x2 = _mm_slli_epi32(s, 14);
+	ha = _mm_xor_si128(x1, x2);
+	x1 = _mm_slli_epi32(s, 19);
+	x2 = _mm_srli_epi32(s, 13);
+	hb = _mm_or_si128(x1, x2);
+}
+
+static inline void vh_step128(v4si& ha, v4si& hb, const v4si* data)
+{
+	vh_step128(ha, hb, _mm_loadu_si128(data));
+}
+
+// process nblocks blocks, but only for registers r0 .. r0+nr-1 of the virtual register
+// h1 .. h4 hold only those nr registers, this works because all lanes are independent
+void EXT(VectorHashLanes128)(const v4si* data, size_t nblocks, size_t r0, size_t nr,
+							  v4si h1[], v4si h2[], v4si h3[], v4si h4[])
+{
+	data += r0;
+	for( size_t i=0; i < nblocks; i++ )
+	{
+		for( size_t j=0; j < nr; j++ )
+		{
+			vh_step128(h1[j], h2[j], data + j);
+			vh_step128(h2[j], h3[j], data + nreg128 + j);
+			vh_step128(h3[j], h4[j], data + 2*nreg128 + j);
+			vh_step128(h4[j], h1[j], data + 3*nreg128 + j);
+		}
+		data += 4*nreg128;
+	}
+}
+
+// process nblocks blocks of M independent messages in lockstep. For narrow checksums each step depends
+// on the previous one, so a single message leaves most execution units idle. Interleaving the steps of
+// several messages hides that latency. The state of message m is stored in h[4*nreg128*m] onwards.
+template<size_t M>
+static inline void vh_interleave128(const v4si* data[], size_t nblocks, v4si h[])
+{
+	v4si z[M][4][nreg128];
+	for( size_t m=0; m < M; m++ )
+		for( size_t q=0; q < 4; q++ )
+			VEC( nreg128, z[m][q][j] = h[(4*m+q)*nreg128+j] );
+
+	size_t pfd;
+	size_t npf = PrefetchBlocks( nblocks*blocksize, blocksize, pfd );
+	for( size_t i=0; i < nblocks; i++ )
+	{
+		if( i < npf )
+			for( size_t m=0; m < M; m++ )
+				prefetch_block( (const uint8_t*)data[m] + pfd, blocksize );
+		for( size_t q=0; q < 4; q++ )
+			for( size_t m=0; m < M; m++ )
+				VEC( nreg128, vh_step128(z[m][q][j], z[m][(q+1)%4][j], data[m] + q*nreg128 + j) );
+		for( size_t m=0; m < M; m++ )
+			data[m] += 4*nreg128;
+	}
+
+	for( size_t m=0; m < M; m++ )
+		for( size_t q=0; q < 4; q++ )
+			VEC( nreg128, h[(4*m+q)*nreg128+j] = z[m][q][j] );
+}
+
+// process nblocks blocks of each of the m <= vh_max_interleave messages, data[] is advanced past them
+void EXT(VectorHashInterleave128)(const v4si* data[], size_t m, size_t nblocks, v4si h[])
+{
+	if( m == 4 )
+		vh_interleave128<4>(data, nblocks, h);
+	else if( m == 3 )
+		vh_interleave128<3>(data, nblocks, h);
+	else if( m == 2 )
+		vh_interleave128<2>(data, nblocks, h);
+	else if( m == 1 )
+	{
+		EXT(VectorHashBlocks128)(data[0], nblocks, h, h+nreg128, h+2*nreg128, h+3*nreg128);
+		data[0] += nblocks*4*nreg128;
+	}
+}
+
+// process nblocks blocks of the same data for M state sets in lockstep. Each register of the data is loaded
+// once and then used for all M sets, which is what is needed for checksums of one buffer with several seeds.
+// The state of set m is stored in h[4*nreg128*m] onwards.
+template<size_t M>
+static inline void vh_shared128(const v4si* data, size_t nblocks, v4si h[])
+{
+	v4si z[M][4][nreg128];
+	for( size_t m=0; m < M; m++ )
+		for( size_t q=0; q < 4; q++ )
+			VEC( nreg128, z[m][q][j] = h[(4*m+q)*nreg128+j] );
 
-	size_t nblocks = len/blocksize;
-	const v4si* data = (const v4si*)buffer;
 	for( size_t i=0; i < nblocks; i++ )
 	{
-		EXT(VectorHashBody128)(data, h1, h2, h3, h4);
+		for( size_t q=0; q < 4; q++ )
+			for( size_t j=0; j < nreg128; j++ )
+			{
+				v4si d = _mm_loadu_si128(data + q*nreg128 + j);
+				for( size_t m=0; m < M; m++ )
+					vh_step128(z[m][q][j], z[m][(q+1)%4][j], d);
+			}
 		data += 4*nreg128;
 	}
 
+	for( size_t m=0; m < M; m++ )
+		for( size_t q=0; q < 4; q++ )
+			VEC( nreg128, h[(4*m+q)*nreg128+j] = z[m][q][j] );
+}
+
+// process nblocks blocks of the same data for m state sets, stored as in vh_shared128, the sets are taken
+// nshared128 at a time, so the data should be small enough to stay in the cache between the groups
+void EXT(VectorHashShared128)(const v4si* data, size_t nblocks, size_t m, v4si h[])
+{
+	for( size_t k=0; k < m; k += nshared128 )
+	{
+		v4si* hk = h + 4*nreg128*k;
+		size_t mk = min(nshared128, m-k);
+		if( mk == 4 )
+			vh_shared128<4>(data, nblocks, hk);
+		else if( mk == 3 )
+			vh_shared128<3>(data, nblocks, hk);
+		else if( mk == 2 )
+			vh_shared128<2>(data, nblocks, hk);
+		else
+			EXT(VectorHashBlocks128)(data, nblocks, hk, hk+nreg128, hk+2*nreg128, hk+3*nreg128);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Finalization - this gives results identical to EXT(VectorHashFinalize)
+
+// rotate all lanes of x left by r bits
+static inline v4si vh_rol128(v4si x, int r)
+{
+	return _mm_or_si128(_mm_slli_epi32(x, r), _mm_srli_epi32(x, 32-r));
+}
+
+// the SIMD equivalent of fmix32
+static inline v4si vh_fmix128(v4si h0, v4si h1)
+{
+	h1 = _mm_xor_si128(h1, h0);
+	h0 = _mm_xor_si128(vh_rol128(h0, 11), h1);
+	h0 = _mm_xor_si128(h0, vh_rol128(h1, 13));
+	h1 = vh_rol128(h1, 19);
+	return _mm_add_epi32(h0, h1);
+}
+
+// copy the first lane of x, or the last lane of x[nreg128-1] in the second form, to all lanes
+static inline v4si vh_first128(const v4si x[])
+{
+	return _mm_shuffle_epi32(x[0], 0x00);
+}
+
+static inline v4si vh_last128(const v4si x[])
+{
+	return _mm_shuffle_epi32(x[nreg128-1], 0xff);
+}
+
+// register j of x with the words reversed within each chunk, a chunk spans several registers
+static inline v4si vh_mirror128(const v4si x[], size_t j)
+{
+	return _mm_shuffle_epi32(x[j ^ (vh_nchunk-1)/4], 0x1b);
+}
+
+// replace x by its inclusive prefix sum over all vh_nint lanes
+static inline void vh_prefix128(v4si x[])
+{
+	v4si carry = _mm_setzero_si128();
+	for( size_t j=0; j < nreg128; j++ )
+	{
+		v4si s = x[j];
+		s = _mm_add_epi32(s, _mm_slli_si128(s, 4));
+		s = _mm_add_epi32(s, _mm_slli_si128(s, 8));
+		x[j] = _mm_add_epi32(s, carry);
+		carry = _mm_shuffle_epi32(x[j], 0xff);
+	}
+}
+
+// replace the first lane of x by the first lane of y
+static inline v4si vh_movefirst128(v4si x, v4si y)
+{
+	return _mm_castps_si128(_mm_move_ss(_mm_castsi128_ps(x), _mm_castsi128_ps(y)));
+}
+
+// Lane mixing, this is equivalent to the following loop over the lanes j > 0:
+//   a[0] += b[j]; b[0] += c[j]; c[0] += d[j]; d[0] += a[j]; a[j] += b[0]; b[j] += c[0]; c[j] += d[0]; d[j] += a[0];
+// The running totals in lane 0 are prefix sums, so all lanes can be done at once.
+static inline void vh_chain128(v4si a[], v4si b[], v4si c[], v4si d[])
+{
+	v4si pa[nreg128], pb[nreg128], pc[nreg128], pd[nreg128];
+	VEC( nreg128, pa[j] = b[j] );
+	VEC( nreg128, pb[j] = c[j] );
+	VEC( nreg128, pc[j] = d[j] );
+	VEC( nreg128, pd[j] = a[j] );
+	vh_prefix128(pa);
+	vh_prefix128(pb);
+	vh_prefix128(pc);
+	vh_prefix128(pd);
+	// pa[j] now holds b[0] + ... + b[j], this needs to become a[0] + b[1] + ... + b[j], etc.
+	v4si ea = vh_first128(a), eb = vh_first128(b), ec = vh_first128(c), ed = vh_first128(d);
+	v4si fa = _mm_sub_epi32(ea, eb), fb = _mm_sub_epi32(eb, ec);
+	v4si fc = _mm_sub_epi32(ec, ed), fd = _mm_sub_epi32(ed, ea);
+	VEC( nreg128, pa[j] = _mm_add_epi32(pa[j], fa) );
+	VEC( nreg128, pb[j] = _mm_add_epi32(pb[j], fb) );
+	VEC( nreg128, pc[j] = _mm_add_epi32(pc[j], fc) );
+	VEC( nreg128, pd[j] = _mm_add_epi32(pd[j], fd) );
+	VEC( nreg128, a[j] = _mm_add_epi32(a[j], pb[j]) );
+	VEC( nreg128, b[j] = _mm_add_epi32(b[j], pc[j]) );
+	VEC( nreg128, c[j] = _mm_add_epi32(c[j], pd[j]) );
+	VEC( nreg128, d[j] = _mm_add_epi32(d[j], pa[j]) );
+	// lane 0 ends up with the complete totals
+	a[0] = vh_movefirst128(a[0], vh_last128(pa));
+	b[0] = vh_movefirst128(b[0], vh_last128(pb));
+	c[0] = vh_movefirst128(c[0], vh_last128(pc));
+	d[0] = vh_movefirst128(d[0], vh_last128(pd));
+}
+
+static inline void vh_finalize128(size_t len, v4si h1[], v4si h2[], v4si h3[], v4si h4[], void* out, size_t hw)
+{
+	v4si lenc = _mm_set1_epi32(int(fmix32(len & 0x7fffffff)));
+	VEC( nreg128, h1[j] = _mm_xor_si128(h1[j], lenc) );
+	VEC( nreg128, h2[j] = _mm_xor_si128(h2[j], lenc) );
+	VEC( nreg128, h3[j] = _mm_xor_si128(h3[j], lenc) );
+	VEC( nreg128, h4[j] = _mm_xor_si128(h4[j], lenc) );
+
+	vh_chain128(h1, h2, h3, h4);
+
+	VEC( nreg128, h1[j] = _mm_add_epi32(h1[j], h2[j]) );
+	VEC( nreg128, h1[j] = _mm_add_epi32(h1[j], h3[j]) );
+	VEC( nreg128, h1[j] = _mm_add_epi32(h1[j], h4[j]) );
+	VEC( nreg128, h2[j] = _mm_add_epi32(h2[j], h1[j]) );
+	VEC( nreg128, h3[j] = _mm_add_epi32(h3[j], h1[j]) );
+	VEC( nreg128, h4[j] = _mm_add_epi32(h4[j], h1[j]) );
+	VEC( nreg128, h1[j] = vh_fmix128(h1[j], h3[j]) );
+	VEC( nreg128, h2[j] = vh_fmix128(h2[j], h4[j]) );
+	VEC( nreg128, h3[j] = vh_fmix128(h3[j], h1[j]) );
+	VEC( nreg128, h4[j] = vh_fmix128(h4[j], h2[j]) );
+	VEC( nreg128, h1[j] = _mm_add_epi32(h1[j], h2[j]) );
+	VEC( nreg128, h1[j] = _mm_add_epi32(h1[j], h3[j]) );
+	VEC( nreg128, h1[j] = _mm_add_epi32(h1[j], h4[j]) );
+	VEC( nreg128, h2[j] = _mm_add_epi32(h2[j], h1[j]) );
+	VEC( nreg128, h3[j] = _mm_add_epi32(h3[j], h1[j]) );
+	VEC( nreg128, h4[j] = _mm_add_epi32(h4[j], h1[j]) );
+
+	vh_chain128(h1, h4, h3, h2);
+
+	// mix each word with the mirrored word in the chunk half a state further on
+	alignas(64) uint32_t Y[4*vh_nint];
+	v4si* y = (v4si*)Y;
+	const v4si c = _mm_set1_epi32(int(0xd86b048b));
+	VEC( nreg128, _mm_store_si128(y+j, vh_fmix128(_mm_xor_si128(h1[j], vh_mirror128(h3, j)), c)) );
+	VEC( nreg128, _mm_store_si128(y+nreg128+j, vh_fmix128(_mm_xor_si128(h2[j], vh_mirror128(h4, j)), c)) );
+	VEC( nreg128, _mm_store_si128(y+2*nreg128+j, vh_fmix128(_mm_xor_si128(h3[j], vh_mirror128(h1, j)), c)) );
+	VEC( nreg128, _mm_store_si128(y+3*nreg128+j, vh_fmix128(_mm_xor_si128(h4[j], vh_mirror128(h2, j)), c)) );
+	vh_fold_finish( Y, out, hw );
+}
+
+void EXT(VectorHashFinalize128)(size_t len, v4si h1[], v4si h2[], v4si h3[], v4si h4[], void* out, size_t hw)
+{
+	vh_finalize128(len, h1, h2, h3, h4, out, hw);
+}
+
+//-----------------------------------------------------------------------------
+// The last block - the padded block is assembled from whole registers and is then
+// processed together with the finalization in a single routine. For messages that
+// are shorter than a block the state is set up directly from the seed, so that no
+// other routines are called at all.
+
+// this gives the same state as calling stateinit four times
+static inline void vh_init128(uint32_t seed, v4si h1[], v4si h2[], v4si h3[], v4si h4[])
+{
+	v4si s1 = _mm_set1_epi32(int(seed));
+	seed = fmix32(seed);
+	v4si s2 = _mm_set1_epi32(int(seed));
+	seed = fmix32(seed);
+	v4si s3 = _mm_set1_epi32(int(seed));
+	seed = fmix32(seed);
+	v4si s4 = _mm_set1_epi32(int(seed));
+	VEC( nreg128, h1[j] = s1 );
+	VEC( nreg128, h2[j] = s2 );
+	VEC( nreg128, h3[j] = s3 );
+	VEC( nreg128, h4[j] = s4 );
+}
+
+// store the last n < blocksize bytes of a message followed by the padding in buf, this gives the same
+// result as pad_buffer, but buf is written one register at a time, so that reading it back is fast
+static inline void vh_pad128(const uint8_t* src, size_t n, v4si buf[])
+{
+	for( size_t j=0; j < 4*nreg128; j++ )
+	{
+		size_t o = j*sizeof(v4si);
+		if( o + sizeof(v4si) <= n )
+			buf[j] = _mm_loadu_si128((const v4si*)(src+o));
+		else if( o >= n )
+			buf[j] = _mm_loadu_si128((const v4si*)(vh_pad_pattern+(o-n)));
+		else
+		{
+			// the register straddles the end of the message, the padding pattern is zero in front of its first byte
+			alignas(16) uint8_t t[sizeof(v4si)] = { 0 };
+			memcpy( t, src+o, n-o );
+			v4si p = _mm_loadu_si128((const v4si*)(vh_pad_pattern - (n-o)));
+			buf[j] = _mm_or_si128(p, _mm_load_si128((const v4si*)t));
+		}
+	}
+}
+
+// checksum of a buffer of len bytes, of which the first ndone blocks have already been
+// processed, h1 .. h4 must hold the state after those blocks on entry
+static inline void vh_finish128(const void* buffer, size_t len, size_t ndone,
+								v4si h1[], v4si h2[], v4si h3[], v4si h4[], void* out, size_t hw)
+{
+	size_t nblocks = len/blocksize;
+	const v4si* data = (const v4si*)buffer + ndone*4*nreg128;
+	EXT(VectorHashBlocks128)(data, nblocks-ndone, h1, h2, h3, h4);
+	data += (nblocks-ndone)*4*nreg128;
+
 	// pad the remaining characters and process...
 	v4si buf[blocksize/sizeof(v4si)];
-	pad_buffer( (const uint8_t*)data, (uint8_t*)buf, len-nblocks*blocksize, blocksize );
-	EXT(VectorHashBody128)(buf, h1, h2, h3, h4);
+	vh_pad128( (const uint8_t*)data, len-nblocks*blocksize, buf );
+	vh_body128(buf, h1, h2, h3, h4);
+
+	vh_finalize128(len, h1, h2, h3, h4, out, hw);
+}
+
+void EXT(VectorHash128)(const void* buffer, size_t len, uint32_t seed, void* out, size_t hw)
+{
+	v4si h1[nreg128], h2[nreg128], h3[nreg128], h4[nreg128];
+	vh_init128(seed, h1, h2, h3, h4);
+	vh_finish128(buffer, len, 0, h1, h2, h3, h4, out, hw);
+}
+
+// checksums of n independent buffers with the same seed, the initial state is only calculated once
+// and groups of ninter128 buffers are processed in lockstep as far as their lengths allow
+void EXT(VectorHashBatch128)(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed, void* outs,
+							 size_t hw)
+{
+	v4si z[4*nreg128];
+	vh_init128(seed, z, z+nreg128, z+2*nreg128, z+3*nreg128);
 
-	uint32_t* z1 = (uint32_t*)h1;
-	uint32_t* z2 = (uint32_t*)h2;
-	uint32_t* z3 = (uint32_t*)h3;
-	uint32_t* z4 = (uint32_t*)h4;
-	EXT(VectorHashFinalize)(len, z1, z2, z3, z4, out, hw);
+	uint8_t* out = (uint8_t*)outs;
+	for( size_t k=0; k < n; k += ninter128 )
+	{
+		size_t m = min(ninter128, n-k);
+		v4si h[ninter128*4*nreg128];
+		const v4si* data[ninter128];
+		size_t ncommon = SIZE_MAX;
+		for( size_t i=0; i < m; i++ )
+		{
+			VEC( 4*nreg128, h[4*nreg128*i+j] = z[j] );
+			data[i] = (const v4si*)bufs[k+i];
+			ncommon = min(ncommon, lens[k+i]/blocksize);
+		}
+		if( m == 1 )
+			ncommon = 0;
+		EXT(VectorHashInterleave128)(data, m, ncommon, h);
+		for( size_t i=0; i < m; i++ )
+		{
+			v4si* hi = &h[4*nreg128*i];
+			vh_finish128(bufs[k+i], lens[k+i], ncommon, hi, hi+nreg128, hi+2*nreg128, hi+3*nreg128,
+						 out + (k+i)*(hw/8), hw);
+		}
+	}
+}
+#else
+void EXT(VectorHashBody128)(const v4si*, v4si[], v4si[], v4si[], v4si[])
+{
+	(void)0;
 }
+
+void EXT(VectorHashBlocks128)(const v4si*, size_t, v4si[], v4si[], v4si[], v4si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashLanes128)(const v4si*, size_t, size_t, size_t, v4si[], v4si[], v4si[], v4si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashInterleave128)(const v4si*[], size_t, size_t, v4si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashShared128)(const v4si*, size_t, size_t, v4si[])
+{
+	(void)0;
+}
+
+void EXT(VectorHashFinalize128)(size_t, v4si[], v4si[], v4si[], v4si[], void*, size_t)
+{
+	(void)0;
+}
+
+void EXT(VectorHash128)(const void*, size_t, uint32_t, void*, size_t)
+{
+	(void)0;
+}
+
+void EXT(VectorHashBatch128)(const void* const[], const size_t[], size_t, uint32_t, void*, size_t)
+{
+	(void)0;
+}
+#endif
@@ -26,6 +26,53 @@ void VectorHashBody128_256(const v4si* data, v4si h1[], v4si h2[], v4si h3[], v4
 void VectorHashBody128_512(const v4si* data, v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
 void VectorHashBody128_1024(const v4si* data, v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
 
+void VectorHashBlocks128_32(const v4si* data, size_t nblocks,
+							v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
+void VectorHashBlocks128_64(const v4si* data, size_t nblocks,
+							v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
+void VectorHashBlocks128_128(const v4si* data, size_t nblocks,
+							v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
+void VectorHashBlocks128_256(const v4si* data, size_t nblocks,
+							v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
+void VectorHashBlocks128_512(const v4si* data, size_t nblocks,
+							v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
+void VectorHashBlocks128_1024(const v4si* data, size_t nblocks,
+							v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
+
+void VectorHashLanes128_32(const v4si* data, size_t nblocks, size_t r0, size_t nr,
+						   v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
+void VectorHashLanes128_64(const v4si* data, size_t nblocks, size_t r0, size_t nr,
+						   v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
+void VectorHashLanes128_128(const v4si* data, size_t nblocks, size_t r0, size_t nr,
+						   v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
+void VectorHashLanes128_256(const v4si* data, size_t nblocks, size_t r0, size_t nr,
+						   v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
+void VectorHashLanes128_512(const v4si* data, size_t nblocks, size_t r0, size_t nr,
+						   v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
+void VectorHashLanes128_1024(const v4si* data, size_t nblocks, size_t r0, size_t nr,
+						   v4si h1[], v4si h2[], v4si h3[], v4si h4[]);
+
+void VectorHashInterleave128_32(const v4si* data[], size_t m, size_t nblocks, v4si h[]);
+void VectorHashInterleave128_64(const v4si* data[], size_t m, size_t nblocks, v4si h[]);
+void VectorHashInterleave128_128(const v4si* data[], size_t m, size_t nblocks, v4si h[]);
+void VectorHashInterleave128_256(const v4si* data[], size_t m, size_t nblocks, v4si h[]);
+void VectorHashInterleave128_512(const v4si* data[], size_t m, size_t nblocks, v4si h[]);
+void VectorHashInterleave128_1024(const v4si* data[], size_t m, size_t nblocks, v4si h[]);
+
+void VectorHashShared128_32(const v4si* data, size_t nblocks, size_t m, v4si h[]);
+void VectorHashShared128_64(const v4si* data, size_t nblocks, size_t m, v4si h[]);
+void VectorHashShared128_128(const v4si* data, size_t nblocks, size_t m, v4si h[]);
+void VectorHashShared128_256(const v4si* data, size_t nblocks, size_t m, v4si h[]);
+void VectorHashShared128_512(const v4si* data, size_t nblocks, size_t m, v4si h[]);
+void VectorHashShared128_1024(const v4si* data, size_t nblocks, size_t m, v4si h[]);
+
+void VectorHashFinalize128_32(size_t len, v4si h1[], v4si h2[], v4si h3[], v4si h4[], void* out, size_t hw);
+void VectorHashFinalize128_64(size_t len, v4si h1[], v4si h2[], v4si h3[], v4si h4[], void* out, size_t hw);
+void VectorHashFinalize128_128(size_t len, v4si h1[], v4si h2[], v4si h3[], v4si h4[], void* out, size_t hw);
+void VectorHashFinalize128_256(size_t len, v4si h1[], v4si h2[], v4si h3[], v4si h4[], void* out, size_t hw);
+void VectorHashFinalize128_512(size_t len, v4si h1[], v4si h2[], v4si h3[], v4si h4[], void* out, size_t hw);
+void VectorHashFinalize128_1024(size_t len, v4si h1[], v4si h2[], v4si h3[], v4si h4[], void* out, size_t hw);
+
 void VectorHash128_32(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 void VectorHash128_64(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 void VectorHash128_128(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
@@ -33,4 +80,17 @@ void VectorHash128_256(const void* buf, size_t len, uint32_t seed, void* out, si
 void VectorHash128_512(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 void VectorHash128_1024(const void* buf, size_t len, uint32_t seed, void* out, size_t hw);
 
+void VectorHashBatch128_32(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+						   void* outs, size_t hw);
+void VectorHashBatch128_64(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+						   void* outs, size_t hw);
+void VectorHashBatch128_128(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+							void* outs, size_t hw);
+void VectorHashBatch128_256(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+							void* outs, size_t hw);
+void VectorHashBatch128_512(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+							void* outs, size_t hw);
+void VectorHashBatch128_1024(const void* const bufs[], const size_t lens[], size_t n, uint32_t seed,
+							 void* outs, size_t hw);
+
 #endif
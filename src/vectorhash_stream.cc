@@ -0,0 +1,348 @@
+//-------------------------------------------------------------------------------
+//  VectorHash - a very fast hash function optimized using SIMD instructions
+//
+//  Copyright (c) 2018-2025 Peter A.M. van Hoof
+//  All Rights Reserved
+//
+//  Distributed under the "zlib license". See the accompanying LICENSE file.
+//-------------------------------------------------------------------------------
+
+#include <iostream>
+#include <cstring>
+#include <vector>
+#ifndef _MSC_VER
+#include <sys/uio.h>
+#endif
+#include "vectorhash.h"
+#include "vectorhash_priv.h"
+#include "vectorhash_core.h"
+
+//-----------------------------------------------------------------------------
+// Incremental interface: the checksum of a buffer can be calculated in pieces
+// by calling VectorHashUpdate repeatedly. The result is identical to calling
+// VectorHash on the concatenation of all the pieces.
+
+static_assert( sizeof(((vh_state*)0)->h[0]) == vh_max_nint*sizeof(uint32_t), "state vector has incorrect size" );
+static_assert( sizeof(((vh_state*)0)->tail) == 4*vh_max_nint*sizeof(uint32_t), "tail buffer has incorrect size" );
+
+void VectorHashInit(vh_state* state, uint32_t seed, is_type SIMDversion, size_t hw)
+{
+	size_t nint = nint_for_width(hw);
+	if( hw < 32 || nint > vh_max_nint )
+	{
+		cout << "Internal error: impossible value for hash width: " << hw << "." << endl;
+		exit(1);
+	}
+	memset( state, 0, sizeof(vh_state) );
+	state->seed = seed;
+	for( size_t i=0; i < 4; i++ )
+		stateinit( state->h[i], seed, nint );
+	state->hash_width = hw;
+	state->simd = SIMDversion;
+}
+
+void VectorHashInit(vh_state* state, uint32_t seed, size_t hw)
+{
+	VectorHashInit(state, seed, GetCachedSIMDVersion(), hw);
+}
+
+void VectorHashUpdate(vh_state* state, const void* buf, size_t len)
+{
+	size_t hw = state->hash_width;
+	size_t nint = nint_for_width(hw);
+	size_t bs = blocksize_for_width(hw);
+	is_type SIMDversion = is_type(state->simd);
+	const uint8_t* data = (const uint8_t*)buf;
+
+	state->len += len;
+
+	// first try to complete a partial block left over from the previous call
+	if( state->ntail > 0 )
+	{
+		size_t n = min(len, bs - state->ntail);
+		memcpy( state->tail + state->ntail, data, n );
+		state->ntail += n;
+		data += n;
+		len -= n;
+		if( state->ntail < bs )
+			return;
+	}
+
+	size_t nblocks = len/bs;
+	if( state->ntail > 0 || nblocks > 0 )
+	{
+		vh_lanes z;
+		z.load( state, nint );
+		if( state->ntail > 0 )
+		{
+			VectorHashBlocks( state->tail, 1, z.h[0], z.h[1], z.h[2], z.h[3], SIMDversion, hw );
+			state->ntail = 0;
+		}
+		VectorHashBlocks( data, nblocks, z.h[0], z.h[1], z.h[2], z.h[3], SIMDversion, hw );
+		z.store( state, nint );
+		data += nblocks*bs;
+		len -= nblocks*bs;
+	}
+
+	// save the remaining bytes for the next call
+	memcpy( state->tail, data, len );
+	state->ntail = len;
+}
+
+void VectorHashFinal(const vh_state* state, void* out)
+{
+	// the state is not altered, so more data can be added after this call
+	size_t hw = state->hash_width;
+	size_t nint = nint_for_width(hw);
+	size_t bs = blocksize_for_width(hw);
+
+	vh_lanes z;
+	z.load( state, nint );
+
+	// pad the remaining characters and process...
+	alignas(64) uint8_t block[sizeof(state->tail)];
+	pad_buffer( state->tail, block, state->ntail, bs );
+	VectorHashBlocks( block, 1, z.h[0], z.h[1], z.h[2], z.h[3], is_type(state->simd), hw );
+
+	VectorHashFinalize( state->len, z.h[0], z.h[1], z.h[2], z.h[3], out, is_type(state->simd), hw );
+}
+
+//-----------------------------------------------------------------------------
+// Saved states: the state of an incremental calculation can be stored and loaded
+// again later, e.g. to resume hashing a huge file after a crash. All SIMD versions
+// use the same state, so only the words in use, the tail, and the counters are
+// stored, in little-endian byte order. The layout (version 1) is:
+//
+//   "VHST", version, hash width, seed, ntail (uint32_t each), len (uint64_t),
+//   4*nint state words, ntail tail bytes, 32-bit VectorHash of all the above
+
+static const uint8_t vh_state_magic[4] = { 'V', 'H', 'S', 'T' };
+static const uint32_t vh_state_version = 1;
+static const size_t vh_state_header = 28;
+// the seed used for the check sum of a saved state
+static const uint32_t vh_state_seed = 0x53617665;
+
+static_assert( vh_state_header + 4*vh_max_nint*sizeof(uint32_t) + 4*vh_max_nint*sizeof(uint32_t) - 1 +
+			   sizeof(uint32_t) <= VH_STATE_SAVE_MAX, "VH_STATE_SAVE_MAX is too small" );
+
+static size_t SavedStateSize(size_t hw, size_t ntail)
+{
+	return vh_state_header + 4*nint_for_width(hw)*sizeof(uint32_t) + ntail + sizeof(uint32_t);
+}
+
+size_t VectorHashStateSave(const vh_state* state, void* buf, size_t size)
+{
+	size_t hw = state->hash_width;
+	size_t nint = nint_for_width(hw);
+	size_t n = SavedStateSize(hw, state->ntail);
+	if( size < n )
+		return 0;
+	uint8_t* p = (uint8_t*)buf;
+	memcpy( p, vh_state_magic, 4 );
+	uint32_t hdr[4] = { vh_state_version, state->hash_width, state->seed, state->ntail };
+	store_words( p+4, hdr, 4 );
+	store_uint64( p+20, state->len );
+	p += vh_state_header;
+	for( size_t i=0; i < 4; i++ )
+	{
+		store_words( p, state->h[i], nint );
+		p += nint*sizeof(uint32_t);
+	}
+	memcpy( p, state->tail, state->ntail );
+	p += state->ntail;
+	uint32_t check;
+	VectorHash( buf, n-sizeof(uint32_t), vh_state_seed, &check, IS_SCALAR, 32 );
+	store_words( p, &check, 1 );
+	return n;
+}
+
+int VectorHashStateLoad(vh_state* state, const void* buf, size_t size)
+{
+	const uint8_t* p = (const uint8_t*)buf;
+	if( size < vh_state_header || memcmp( p, vh_state_magic, 4 ) != 0 )
+		return -1;
+	uint32_t hdr[4];
+	load_words( p+4, hdr, 4 );
+	size_t hw = hdr[1], ntail = hdr[3];
+	if( hdr[0] != vh_state_version || hw < 32 || hw > 1024 || hw%32 != 0 || ntail >= blocksize_for_width(hw) )
+		return -1;
+	size_t n = SavedStateSize(hw, ntail);
+	uint64_t len = load_uint64( p+20 );
+	if( size != n || len%blocksize_for_width(hw) != ntail )
+		return -1;
+	uint32_t check, saved;
+	VectorHash( buf, n-sizeof(uint32_t), vh_state_seed, &check, IS_SCALAR, 32 );
+	load_words( p+n-sizeof(uint32_t), &saved, 1 );
+	if( check != saved )
+		return -1;
+
+	size_t nint = nint_for_width(hw);
+	memset( state, 0, sizeof(vh_state) );
+	state->hash_width = uint32_t(hw);
+	state->seed = hdr[2];
+	state->ntail = uint32_t(ntail);
+	state->len = len;
+	state->simd = GetCachedSIMDVersion();
+	p += vh_state_header;
+	for( size_t i=0; i < 4; i++ )
+	{
+		load_words( p, state->h[i], nint );
+		p += nint*sizeof(uint32_t);
+	}
+	memcpy( state->tail, p, ntail );
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Checksums of several widths or seeds in a single pass. The data are passed to
+// the states one slice at a time, so that the slice is still in the cache when
+// the next state reads it, and the buffer is only read from memory once. States
+// that only differ in their seed are advanced together with VectorHashShared, so
+// that each register of the data is loaded only once for all of them.
+
+// this must be a multiple of the largest block size, and fit comfortably in the L2 cache
+static const size_t vh_multi_slice = size_t(64) << 10;
+// the largest number of states that are passed to VectorHashShared in a single call
+static const size_t vh_max_shared = 16;
+
+// can the states be advanced together by VectorHashShared?
+inline bool SameLayout(const vh_state* a, const vh_state* b)
+{
+	return pow2roundup(a->hash_width) == pow2roundup(b->hash_width) && a->simd == b->simd &&
+		a->ntail == b->ntail;
+}
+
+// advance n <= vh_max_shared states with the same layout over the same data
+static void UpdateShared(vh_state* const states[], size_t n, const uint8_t* data, size_t len)
+{
+	size_t hw = states[0]->hash_width;
+	size_t nint = nint_for_width(hw);
+	size_t bs = blocksize_for_width(hw);
+
+	// first complete a partial block left over from the previous call
+	size_t n0 = ( states[0]->ntail > 0 ) ? min(len, bs - states[0]->ntail) : 0;
+	for( size_t k=0; k < n; k++ )
+		VectorHashUpdate( states[k], data, n0 );
+	data += n0;
+	len -= n0;
+
+	size_t nblocks = len/bs;
+	if( nblocks > 0 )
+	{
+		alignas(64) uint32_t h[vh_max_shared*4*vh_max_nint];
+		for( size_t k=0; k < n; k++ )
+			for( size_t q=0; q < 4; q++ )
+				memcpy( &h[(4*k+q)*nint], states[k]->h[q], nint*sizeof(uint32_t) );
+		VectorHashShared( data, nblocks, n, h, is_type(states[0]->simd), hw );
+		for( size_t k=0; k < n; k++ )
+		{
+			for( size_t q=0; q < 4; q++ )
+				memcpy( states[k]->h[q], &h[(4*k+q)*nint], nint*sizeof(uint32_t) );
+			states[k]->len += nblocks*bs;
+		}
+		data += nblocks*bs;
+		len -= nblocks*bs;
+	}
+
+	for( size_t k=0; k < n; k++ )
+		VectorHashUpdate( states[k], data, len );
+}
+
+void VectorHashUpdateMulti(vh_state* const states[], size_t n, const void* buf, size_t len)
+{
+	const uint8_t* data = (const uint8_t*)buf;
+	for( size_t off=0; off < len; off += vh_multi_slice )
+	{
+		size_t m = min(vh_multi_slice, len-off);
+		for( size_t i=0; i < n; )
+		{
+			size_t k = i+1;
+			while( k < n && k-i < vh_max_shared && SameLayout(states[i], states[k]) )
+				k++;
+			if( k-i > 1 )
+				UpdateShared(states+i, k-i, data+off, m);
+			else
+				VectorHashUpdate(states[i], data+off, m);
+			i = k;
+		}
+	}
+}
+
+void VectorHashMulti(const void* buf, size_t len, uint32_t seed, void* outs, is_type SIMDversion,
+					 const size_t hw[], size_t n)
+{
+	vector<vh_state> st(n);
+	vector<vh_state*> pst(n);
+	for( size_t i=0; i < n; i++ )
+	{
+		VectorHashInit(&st[i], seed, SIMDversion, hw[i]);
+		pst[i] = &st[i];
+	}
+	VectorHashUpdateMulti(pst.data(), n, buf, len);
+	uint8_t* out = (uint8_t*)outs;
+	for( size_t i=0; i < n; i++ )
+	{
+		VectorHashFinal(&st[i], out);
+		out += hw[i]/8;
+	}
+}
+
+void VectorHashMulti(const void* buf, size_t len, uint32_t seed, void* outs, const size_t hw[], size_t n)
+{
+	VectorHashMulti(buf, len, seed, outs, GetCachedSIMDVersion(), hw, n);
+}
+
+void VectorHashMultiSeed(const void* buf, size_t len, const uint32_t seeds[], size_t n, void* outs,
+						 is_type SIMDversion, size_t hw)
+{
+	uint8_t* out = (uint8_t*)outs;
+	// a buffer that fits in a single slice stays in the cache between the calls anyway
+	if( len < vh_multi_slice )
+	{
+		for( size_t i=0; i < n; i++ )
+			VectorHash(buf, len, seeds[i], out + i*(hw/8), SIMDversion, hw);
+		return;
+	}
+	vector<vh_state> st(n);
+	vector<vh_state*> pst(n);
+	for( size_t i=0; i < n; i++ )
+	{
+		VectorHashInit(&st[i], seeds[i], SIMDversion, hw);
+		pst[i] = &st[i];
+	}
+	VectorHashUpdateMulti(pst.data(), n, buf, len);
+	for( size_t i=0; i < n; i++ )
+		VectorHashFinal(&st[i], out + i*(hw/8));
+}
+
+void VectorHashMultiSeed(const void* buf, size_t len, const uint32_t seeds[], size_t n, void* outs, size_t hw)
+{
+	VectorHashMultiSeed(buf, len, seeds, n, outs, GetCachedSIMDVersion(), hw);
+}
+
+//-----------------------------------------------------------------------------
+// Scatter-gather interface: the checksum of a buffer that consists of several
+// non-contiguous segments. The segments are fed to the incremental interface,
+// which takes care of blocks that straddle two segments, so that no copy of the
+// whole buffer is needed. MSVC does not supply <sys/uio.h>, so it is not available there.
+
+#ifndef _MSC_VER
+void VectorHashV(const struct iovec* iov, int iovcnt, uint32_t seed, void* out, is_type SIMDversion, size_t hw)
+{
+	if( iovcnt == 1 )
+	{
+		VectorHash(iov[0].iov_base, iov[0].iov_len, seed, out, SIMDversion, hw);
+		return;
+	}
+	vh_state state;
+	VectorHashInit(&state, seed, SIMDversion, hw);
+	for( int i=0; i < iovcnt; i++ )
+		VectorHashUpdate(&state, iov[i].iov_base, iov[i].iov_len);
+	VectorHashFinal(&state, out);
+}
+
+void VectorHashV(const struct iovec* iov, int iovcnt, uint32_t seed, void* out, size_t hw)
+{
+	VectorHashV(iov, iovcnt, seed, out, GetCachedSIMDVersion(), hw);
+}
+#endif
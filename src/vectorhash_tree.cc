@@ -0,0 +1,153 @@
+//-------------------------------------------------------------------------------
+//  VectorHash - a very fast hash function optimized using SIMD instructions
+//
+//  Copyright (c) 2018-2025 Peter A.M. van Hoof
+//  All Rights Reserved
+//
+//  Distributed under the "zlib license". See the accompanying LICENSE file.
+//-------------------------------------------------------------------------------
+
+#include <atomic>
+#include <thread>
+#include <system_error>
+#include <vector>
+#include "vectorhash.h"
+#include "vectorhash_priv.h"
+#include "vectorhash_core.h"
+
+//-----------------------------------------------------------------------------
+// Tree mode (VH-tree). This is a separate checksum, it gives different results
+// from VectorHash. The buffer is split into chunks of chunksize bytes (the last
+// one may be shorter) which are checksummed independently with VectorHash. These
+// leaf checksums are then combined pairwise, level by level, until a single node
+// remains. An odd node at the end of a level is moved up unaltered. Finally the
+// length of the buffer and the chunk size are mixed into the root node. Since the
+// chunks are independent, they can be checksummed in parallel, and a sub-range of
+// the buffer can be verified using only the leaf checksums of the other chunks.
+
+// seeds used for the interior nodes and the root, derived from the user seed
+inline uint32_t node_seed(uint32_t seed)
+{
+	return fmix32(seed, 0x4e6f6465);
+}
+
+inline uint32_t root_seed(uint32_t seed)
+{
+	return fmix32(seed, 0x526f6f74);
+}
+
+inline size_t TreeChunksize(size_t chunksize)
+{
+	return ( chunksize == 0 ) ? VH_TREE_CHUNKSIZE : chunksize;
+}
+
+size_t VectorHashTreeLeaves(size_t len, size_t chunksize)
+{
+	chunksize = TreeChunksize(chunksize);
+	return ( len == 0 ) ? 1 : (len-1)/chunksize + 1;
+}
+
+void VectorHashTreeRoot(const void* leaves, size_t nleaves, uint64_t len, uint32_t seed, void* out,
+						is_type SIMDversion, size_t hw, size_t chunksize)
+{
+	// there is always at least one leaf, see VectorHashTreeLeaves
+	if( nleaves == 0 )
+		return;
+	chunksize = TreeChunksize(chunksize);
+	size_t nw = hw/32;
+	size_t nb = 4*nw;
+	vector<uint32_t> level((const uint32_t*)leaves, (const uint32_t*)leaves + nleaves*nw);
+	vector<uint8_t> pair(2*nb+16);
+	uint32_t nseed = node_seed(seed);
+	while( nleaves > 1 )
+	{
+		size_t nparent = 0;
+		for( size_t i=0; i+1 < nleaves; i += 2 )
+		{
+			store_words( &pair[0], &level[i*nw], 2*nw );
+			VectorHash( pair.data(), 2*nb, nseed, &level[nparent*nw], SIMDversion, hw );
+			++nparent;
+		}
+		if( (nleaves&1) == 1 )
+		{
+			for( size_t j=0; j < nw; j++ )
+				level[nparent*nw+j] = level[(nleaves-1)*nw+j];
+			++nparent;
+		}
+		nleaves = nparent;
+	}
+	store_words( &pair[0], &level[0], nw );
+	store_uint64( &pair[nb], len );
+	store_uint64( &pair[nb+8], chunksize );
+	VectorHash( pair.data(), nb+16, root_seed(seed), out, SIMDversion, hw );
+}
+
+static void TreeWorker(const uint8_t* buf, size_t len, uint32_t seed, uint32_t* leaves, is_type SIMDversion,
+					   size_t hw, size_t chunksize, size_t nleaves, atomic<size_t>* next)
+{
+	size_t nw = hw/32;
+	size_t i;
+	while( (i = (*next)++) < nleaves )
+	{
+		size_t start = i*chunksize;
+		size_t n = min(chunksize, len-start);
+		VectorHash( buf+start, n, seed, leaves+i*nw, SIMDversion, hw );
+	}
+}
+
+void VectorHashTreeHashLeaves(const void* buf, size_t len, uint32_t seed, void* leaves, is_type SIMDversion,
+							  size_t hw, size_t chunksize, size_t nthreads)
+{
+	chunksize = TreeChunksize(chunksize);
+	size_t nleaves = VectorHashTreeLeaves(len, chunksize);
+	if( nthreads == 0 )
+		nthreads = max(thread::hardware_concurrency(), 1u);
+	nthreads = min(nthreads, nleaves);
+
+	atomic<size_t> next(0);
+	const uint8_t* p = (const uint8_t*)buf;
+	uint32_t* l = (uint32_t*)leaves;
+	vector<thread> workers;
+	for( size_t w=1; w < nthreads; w++ )
+	{
+		try
+		{
+			workers.emplace_back( TreeWorker, p, len, seed, l, SIMDversion, hw, chunksize, nleaves, &next );
+		}
+		catch( const system_error& )
+		{
+			// we could not start a new thread, the remaining threads will do the work
+			break;
+		}
+	}
+	TreeWorker( p, len, seed, l, SIMDversion, hw, chunksize, nleaves, &next );
+	for( auto& w : workers )
+		w.join();
+}
+
+void VectorHashTree(const void* buf, size_t len, uint32_t seed, void* out, is_type SIMDversion, size_t hw,
+					size_t chunksize, size_t nthreads)
+{
+	size_t nleaves = VectorHashTreeLeaves(len, chunksize);
+	vector<uint32_t> leaves(nleaves*hw/32);
+	VectorHashTreeHashLeaves( buf, len, seed, leaves.data(), SIMDversion, hw, chunksize, nthreads );
+	VectorHashTreeRoot( leaves.data(), nleaves, len, seed, out, SIMDversion, hw, chunksize );
+}
+
+void VectorHashTree(const void* buf, size_t len, uint32_t seed, void* out, size_t hw, size_t chunksize,
+					size_t nthreads)
+{
+	VectorHashTree(buf, len, seed, out, GetCachedSIMDVersion(), hw, chunksize, nthreads);
+}
+
+void VectorHashTreeHashLeaves(const void* buf, size_t len, uint32_t seed, void* leaves, size_t hw, size_t chunksize,
+							  size_t nthreads)
+{
+	VectorHashTreeHashLeaves(buf, len, seed, leaves, GetCachedSIMDVersion(), hw, chunksize, nthreads);
+}
+
+void VectorHashTreeRoot(const void* leaves, size_t nleaves, uint64_t len, uint32_t seed, void* out, size_t hw,
+						size_t chunksize)
+{
+	VectorHashTreeRoot(leaves, nleaves, len, seed, out, GetCachedSIMDVersion(), hw, chunksize);
+}
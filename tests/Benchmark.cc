@@ -0,0 +1,301 @@
+//-------------------------------------------------------------------------------
+//  VectorHash - a very fast hash function optimized using SIMD instructions
+//
+//  Copyright (c) 2018-2025 Peter A.M. van Hoof
+//  All Rights Reserved
+//
+//  Distributed under the "zlib license". See the accompanying LICENSE file.
+//-------------------------------------------------------------------------------
+
+// Timing tests for the VectorHash library. These are not part of "make check"
+// since the results depend on the hardware. Build and run them with "make bench".
+// Without arguments all benchmarks are run, otherwise only the ones named.
+
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "vectorhash.h"
+#include "vectorhash_priv.h"
+#include "vectorhash_core.h"
+
+using namespace std;
+
+namespace {
+
+	typedef chrono::steady_clock vh_clock;
+
+	uint32_t out[1024/32];
+
+	// aligned buffer of at least len bytes filled with pseudo-random data
+	uint8_t* GetBuffer(size_t len)
+	{
+		void* p;
+		if( posix_memalign( &p, 64, len ) != 0 )
+		{
+			cerr << "Benchmark: failed to allocate " << len << " bytes\n";
+			exit(1);
+		}
+		uint8_t* buf = (uint8_t*)p;
+		uint32_t x = 0x12345678;
+		for( size_t i=0; i < len; ++i )
+		{
+			x = fmix32(x);
+			buf[i] = uint8_t(x);
+		}
+		return buf;
+	}
+
+	// call func repeatedly for roughly 0.2 s and return the time per call in ns
+	template<class F>
+	double TimePerCall(F func)
+	{
+		size_t ncall = 0, nrep = 16;
+		auto start = vh_clock::now();
+		double elapsed;
+		do {
+			for( size_t i=0; i < nrep; ++i )
+				func();
+			ncall += nrep;
+			nrep *= 2;
+			elapsed = chrono::duration<double>(vh_clock::now() - start).count();
+		}
+		while( elapsed < 0.2 );
+		return elapsed/double(ncall)*1.e9;
+	}
+
+	// per-call overhead of the dispatch layer
+	void BenchDispatch()
+	{
+		cout << "dispatch: time per call in ns\n";
+		cout << setw(10) << "size" << setw(12) << "CPUID" << setw(12) << "VectorHash"
+			 << setw(12) << "GetImpl" << "\n";
+		static const size_t sizes[] = { 64, 4096, 65536 };
+		uint8_t* buf = GetBuffer(65536);
+		vh_impl impl = VectorHashGetImpl(128);
+		for( auto len : sizes )
+		{
+			// this mimics the old behavior where CPUID was executed on every call
+			double t1 = TimePerCall( [&]() { VectorHash(buf, len, 0, out, GetSIMDVersion(), 128); } );
+			double t2 = TimePerCall( [&]() { VectorHash(buf, len, 0, out, 128); } );
+			double t3 = TimePerCall( [&]() { impl(buf, len, 0, out, 128); } );
+			cout << setw(10) << len << fixed << setprecision(1) << setw(12) << t1 << setw(12) << t2
+				 << setw(12) << t3 << "\n";
+		}
+		free(buf);
+	}
+
+	// throughput for buffers up to several GiB with and without software prefetching
+	void BenchPrefetch()
+	{
+		static const size_t dists[] = { 0, 256, 512, 1024, 2048, 4096 };
+		size_t dist0 = VectorHashGetPrefetch();
+		cout << "prefetch: throughput in GB/s for a 256-bit checksum vs prefetch distance (0 = off)\n";
+		cout << setw(10) << "size";
+		for( auto d : dists )
+			cout << setw(9) << d;
+		cout << "\n";
+		size_t maxlen = size_t(4) << 30;
+		if( sizeof(size_t) == 4 )
+			maxlen = size_t(1) << 30;
+		for( size_t len = 256 << 10; len <= maxlen; len *= 4 )
+		{
+			void* p;
+			if( posix_memalign( &p, 64, len ) != 0 )
+			{
+				cout << "failed to allocate " << len << " bytes, stopping\n";
+				break;
+			}
+			// the contents do not influence the speed, just make sure that the pages are mapped
+			memset( p, 0x5a, len );
+			cout << setw(9) << (len >> 10) << "K";
+			for( auto d : dists )
+			{
+				VectorHashSetPrefetch(d);
+				double t = TimePerCall( [&]() { VectorHash(p, len, 0, out, 256); } );
+				cout << fixed << setprecision(2) << setw(9) << double(len)/t;
+			}
+			cout << endl;
+			free(p);
+		}
+		VectorHashSetPrefetch(dist0);
+	}
+
+	// throughput for narrow checksums where the blocks are short, for a buffer that fits in the L2 cache
+	void BenchNarrow()
+	{
+		static const char* names[] = { "scalar", "sse2", "avx2", "avx512" };
+		static const size_t widths[] = { 32, 64, 128, 256 };
+		const size_t len = 65536;
+		uint8_t* buf = GetBuffer(len);
+		cout << "narrow: throughput in GB/s for a " << len/1024 << " KiB buffer (VectorHash / VectorHashUpdate)\n";
+		cout << setw(10) << "width";
+		for( is_type simd = IS_SCALAR; simd <= GetCachedSIMDVersion(); simd = is_type(simd+1) )
+			cout << setw(16) << names[simd];
+		cout << "\n";
+		for( auto hw : widths )
+		{
+			cout << setw(10) << hw;
+			for( is_type simd = IS_SCALAR; simd <= GetCachedSIMDVersion(); simd = is_type(simd+1) )
+			{
+				double t1 = TimePerCall( [&]() { VectorHash(buf, len, 0, out, simd, hw); } );
+				vh_state st;
+				VectorHashInit(&st, 0, simd, hw);
+				double t2 = TimePerCall( [&]() { VectorHashUpdate(&st, buf, len); } );
+				cout << fixed << setprecision(2) << setw(8) << double(len)/t1 << setw(8) << double(len)/t2;
+			}
+			cout << endl;
+		}
+		free(buf);
+	}
+
+	// many small independent objects, one VectorHash call per object vs a single VectorHashBatch call
+	void BenchBatch()
+	{
+		static const size_t sizes[] = { 256, 4096, 16384, 65536 };
+		const size_t total = size_t(16) << 20;
+		uint8_t* buf = GetBuffer(total);
+		cout << "batch: throughput in GB/s for a 16 MiB buffer split into objects (loop / batch)\n";
+		cout << setw(10) << "size" << setw(16) << "128" << setw(16) << "256" << "\n";
+		for( auto len : sizes )
+		{
+			size_t n = total/len;
+			vector<const void*> bufs(n);
+			vector<size_t> lens(n, len);
+			for( size_t k=0; k < n; ++k )
+				bufs[k] = buf + k*len;
+			cout << setw(10) << len;
+			for( size_t hw = 128; hw <= 256; hw *= 2 )
+			{
+				vector<uint32_t> res(n*hw/32);
+				double t1 = TimePerCall( [&]() {
+					for( size_t k=0; k < n; ++k )
+						VectorHash(bufs[k], len, 0, &res[k*hw/32], hw);
+				} );
+				double t2 = TimePerCall( [&]() { VectorHashBatch(bufs.data(), lens.data(), n, 0, res.data(), hw); } );
+				cout << fixed << setprecision(2) << setw(8) << double(total)/t1 << setw(8) << double(total)/t2;
+			}
+			cout << endl;
+		}
+		free(buf);
+	}
+
+	// cost of the finalization step alone, this dominates the time for short messages
+	void BenchFinalize()
+	{
+		static const char* names[] = { "scalar", "sse2", "avx2", "avx512" };
+		static const size_t widths[] = { 32, 64, 128, 256, 512, 1024 };
+		cout << "finalize: time per call in ns\n";
+		cout << setw(10) << "width";
+		for( is_type simd = IS_SCALAR; simd <= GetCachedSIMDVersion(); simd = is_type(simd+1) )
+			cout << setw(10) << names[simd];
+		cout << "\n";
+		alignas(64) uint32_t h[4][vh_max_nint];
+		for( auto hw : widths )
+		{
+			cout << setw(10) << hw;
+			for( is_type simd = IS_SCALAR; simd <= GetCachedSIMDVersion(); simd = is_type(simd+1) )
+			{
+				uint32_t seed = 0;
+				for( size_t i=0; i < 4; ++i )
+					stateinit( h[i], seed, vh_max_nint );
+				// the state is overwritten, so every call works on the result of the previous one
+				double t = TimePerCall( [&]() { VectorHashFinalize(200, h[0], h[1], h[2], h[3], out, simd, hw); } );
+				cout << fixed << setprecision(1) << setw(10) << t;
+			}
+			cout << endl;
+		}
+	}
+
+	// latency for short keys, as used in hash tables, the key is varied to defeat branch prediction on the contents
+	void BenchShort()
+	{
+		static const size_t sizes[] = { 1, 4, 8, 16, 32, 64, 128, 255, 256, 512, 1024 };
+		static const size_t widths[] = { 32, 64, 128, 256 };
+		uint8_t* buf = GetBuffer(4096);
+		cout << "short: time per call in ns\n";
+		cout << setw(10) << "size";
+		for( auto hw : widths )
+			cout << setw(10) << hw;
+		cout << "\n";
+		for( auto len : sizes )
+		{
+			cout << setw(10) << len;
+			for( auto hw : widths )
+			{
+				size_t off = 0;
+				double t = TimePerCall( [&]() { VectorHash(buf+off, len, 0, out, hw); off = (off+1)&1023; } );
+				cout << fixed << setprecision(1) << setw(10) << t;
+			}
+			cout << endl;
+		}
+		free(buf);
+	}
+
+	// the same buffer hashed with several seeds, one VectorHash call per seed vs a single VectorHashMultiSeed call
+	void BenchMultiSeed()
+	{
+		static const size_t nseeds[] = { 2, 4, 8 };
+		static const size_t sizes[] = { 4096, size_t(1) << 20, size_t(64) << 20 };
+		uint8_t* buf = GetBuffer(sizes[2]);
+		uint32_t seeds[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		uint32_t res[8*256/32];
+		cout << "multiseed: throughput in GB/s of the input buffer for 128-bit checksums (loop / multiseed)\n";
+		cout << setw(10) << "size";
+		for( auto n : nseeds )
+			cout << setw(10) << n << " seeds ";
+		cout << "\n";
+		for( auto len : sizes )
+		{
+			cout << setw(10) << len;
+			for( auto n : nseeds )
+			{
+				double t1 = TimePerCall( [&]() {
+					for( size_t k=0; k < n; ++k )
+						VectorHash(buf, len, seeds[k], &res[k*128/32], 128);
+				} );
+				double t2 = TimePerCall( [&]() { VectorHashMultiSeed(buf, len, seeds, n, res, 128); } );
+				cout << fixed << setprecision(2) << setw(8) << double(len)/t1 << setw(8) << double(len)/t2;
+			}
+			cout << endl;
+		}
+		free(buf);
+	}
+
+	struct benchmark
+	{
+		const char* name;
+		void (*func)();
+	};
+
+	const benchmark benchmarks[] = {
+		{ "dispatch", BenchDispatch },
+		{ "prefetch", BenchPrefetch },
+		{ "narrow", BenchNarrow },
+		{ "batch", BenchBatch },
+		{ "finalize", BenchFinalize },
+		{ "short", BenchShort },
+		{ "multiseed", BenchMultiSeed }
+	};
+
+}
+
+int main(int argc, char** argv)
+{
+	for( const auto& b : benchmarks )
+	{
+		bool lgRun = ( argc == 1 );
+		for( int i=1; i < argc; ++i )
+			if( strcmp(argv[i], b.name) == 0 )
+				lgRun = true;
+		if( lgRun )
+		{
+			b.func();
+			cout << endl;
+		}
+	}
+	return 0;
+}
@@ -522,4 +522,99 @@ namespace {
 		}
 	}
 
+	// test buffers that are not aligned on a 32-byte boundary
+	TEST(TestMisalignedBufferAVX2_32)
+	{
+		if( SIMDversion >= IS_AVX2 )
+		{
+			static const size_t offsets[] = { 1, 2, 4, 8, 12, 16, 32, 48, 63 };
+			for( auto off : offsets )
+			{
+				uint8_t* buf = (uint8_t*)buffer + off;
+				CHECK( ReadBuffer("test9999", 1048576, buf) );
+				VectorHash256_32(buf, 1048576, 0xfd4c799d, cksum, 32);
+				CHECK( CheckHash(cksum, "81dddc5e") );
+			}
+		}
+	}
+
+	TEST(TestMisalignedBufferAVX2_64)
+	{
+		if( SIMDversion >= IS_AVX2 )
+		{
+			static const size_t offsets[] = { 1, 2, 4, 8, 12, 16, 32, 48, 63 };
+			for( auto off : offsets )
+			{
+				uint8_t* buf = (uint8_t*)buffer + off;
+				CHECK( ReadBuffer("test9999", 1048576, buf) );
+				VectorHash256_64(buf, 1048576, 0xfd4c799d, cksum, 64);
+				CHECK( CheckHash(cksum, "021fa7d3f643f834") );
+			}
+		}
+	}
+
+	TEST(TestMisalignedBufferAVX2_128)
+	{
+		if( SIMDversion >= IS_AVX2 )
+		{
+			static const size_t offsets[] = { 1, 2, 4, 8, 12, 16, 32, 48, 63 };
+			for( auto off : offsets )
+			{
+				uint8_t* buf = (uint8_t*)buffer + off;
+				CHECK( ReadBuffer("test9999", 1048576, buf) );
+				VectorHash256_128(buf, 1048576, 0xfd4c799d, cksum, 128);
+				CHECK( CheckHash(cksum, "5c3c9fb8481be32ea676886ab251f4fc") );
+			}
+		}
+	}
+
+	TEST(TestMisalignedBufferAVX2_256)
+	{
+		if( SIMDversion >= IS_AVX2 )
+		{
+			static const size_t offsets[] = { 1, 2, 4, 8, 12, 16, 32, 48, 63 };
+			for( auto off : offsets )
+			{
+				uint8_t* buf = (uint8_t*)buffer + off;
+				CHECK( ReadBuffer("test9999", 1048576, buf) );
+				VectorHash256_256(buf, 1048576, 0xfd4c799d, cksum, 256);
+				CHECK( CheckHash(cksum, "888a7ef5d0feda6a571ca947ece56c8833019cc8dca62dad01e6f9e60dcc29d3") );
+			}
+		}
+	}
+
+	TEST(TestMisalignedBufferAVX2_512)
+	{
+		if( SIMDversion >= IS_AVX2 )
+		{
+			static const size_t offsets[] = { 1, 2, 4, 8, 12, 16, 32, 48, 63 };
+			for( auto off : offsets )
+			{
+				uint8_t* buf = (uint8_t*)buffer + off;
+				CHECK( ReadBuffer("test9999", 1048576, buf) );
+				VectorHash256_512(buf, 1048576, 0xfd4c799d, cksum, 512);
+				CHECK( CheckHash(cksum, "147c905b96a3e78f458bb56cbab1f17c843f70d485b24bfa51d1823602481eea"
+			                            "7890edaf1575a8ef04a57c92fc86353ff5c48c3c8198762f6b409d9aa52bff52") );
+			}
+		}
+	}
+
+	TEST(TestMisalignedBufferAVX2_1024)
+	{
+		if( SIMDversion >= IS_AVX2 )
+		{
+			static const size_t offsets[] = { 1, 2, 4, 8, 12, 16, 32, 48, 63 };
+			for( auto off : offsets )
+			{
+				uint8_t* buf = (uint8_t*)buffer + off;
+				CHECK( ReadBuffer("test9999", 1048576, buf) );
+				VectorHash256_1024(buf, 1048576, 0xfd4c799d, cksum, 1024);
+				CHECK( CheckHash(cksum, "3dfe155d7c8fab0ccf04baf748bf2bd9a0dd00924eb7d3ba94af78ba1976232f"
+			                            "a4ec9c46080893e4321601b07f0e7aeac6a4ab010e505d443889fc978b23b0f9"
+			                            "44ca22d4e4f6079b94b8985dd1adc1b13f4d2a2c08dd53e22f3bb84eb0fbab75"
+			                            "06eff60a3089394a57f98b532a89cd66c7d6d2da971025c0cad83c09a3aa3d21") );
+			}
+		}
+	}
+
 }
@@ -0,0 +1,96 @@
+//-------------------------------------------------------------------------------
+//  VectorHash - a very fast hash function optimized using SIMD instructions
+//
+//  Copyright (c) 2018-2025 Peter A.M. van Hoof
+//  All Rights Reserved
+//
+//  Distributed under the "zlib license". See the accompanying LICENSE file.
+//-------------------------------------------------------------------------------
+
+#include <cstring>
+#include <vector>
+#include "TestMain.h"
+#include "vectorhash_core.h"
+
+namespace {
+
+	TEST(TestBatchFile)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		const void* bufs[] = { buffer };
+		const size_t lens[] = { 1048576 };
+		VectorHashBatch(bufs, lens, 1, 0xfd4c799d, cksum, 128);
+		CHECK( CheckHash(cksum, "5c3c9fb8481be32ea676886ab251f4fc") );
+	}
+
+	TEST(TestBatchLengths)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		// a mix of empty, short, block-sized, and long buffers at odd offsets
+		static const size_t lengths[] = { 0, 1, 3, 63, 64, 65, 127, 128, 255, 256, 1000, 1024, 4096, 4099,
+										  65536, 70001, 1048576-77 };
+		const size_t n = sizeof(lengths)/sizeof(lengths[0]);
+		static const size_t widths[] = { 32, 96, 128, 256, 512, 1024 };
+		const uint8_t* p = (const uint8_t*)buffer;
+		const void* bufs[n];
+		size_t lens[n];
+		for( size_t k=0; k < n; ++k )
+		{
+			bufs[k] = p + (k*37)%64;
+			lens[k] = lengths[k];
+		}
+		uint32_t ref[1024/32];
+		for( is_type simd = IS_SCALAR; simd <= SIMDversion; simd = is_type(simd+1) )
+			for( auto hw : widths )
+			{
+				vector<uint32_t> res(n*hw/32);
+				VectorHashBatch(bufs, lens, n, 0x6ec74615, res.data(), simd, hw);
+				for( size_t k=0; k < n; ++k )
+				{
+					VectorHash(bufs[k], lens[k], 0x6ec74615, ref, simd, hw);
+					CHECK( memcmp(&res[k*hw/32], ref, hw/8) == 0 );
+				}
+			}
+	}
+
+	TEST(TestBatchLockstep)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		// buffers of equal length are processed in lockstep all the way, an odd count leaves one over
+		static const size_t widths[] = { 32, 64, 128, 256, 512, 1024 };
+		static const size_t lengths[] = { 4096, 65536+100 };
+		const size_t n = 7;
+		const uint8_t* p = (const uint8_t*)buffer;
+		uint32_t ref[1024/32];
+		for( auto len : lengths )
+		{
+			const void* bufs[n];
+			size_t lens[n];
+			for( size_t k=0; k < n; ++k )
+			{
+				bufs[k] = p + k*(len+5);
+				lens[k] = len;
+			}
+			for( is_type simd = IS_SCALAR; simd <= SIMDversion; simd = is_type(simd+1) )
+				for( auto hw : widths )
+				{
+					vector<uint32_t> res(n*hw/32);
+					VectorHashBatch(bufs, lens, n, 0xfd4c799d, res.data(), simd, hw);
+					for( size_t k=0; k < n; ++k )
+					{
+						VectorHash(bufs[k], lens[k], 0xfd4c799d, ref, simd, hw);
+						CHECK( memcmp(&res[k*hw/32], ref, hw/8) == 0 );
+					}
+				}
+		}
+	}
+
+	TEST(TestBatchEmpty)
+	{
+		// a batch without buffers must not touch the output
+		uint32_t res[1] = { 0xdeadbeef };
+		VectorHashBatch(NULL, NULL, 0, 0, res, 256);
+		CHECK_EQUAL( res[0], 0xdeadbeef );
+	}
+
+}
@@ -7,6 +7,15 @@
 //  Distributed under the "zlib license". See the accompanying LICENSE file.
 //-------------------------------------------------------------------------------
 
+#include <cstring>
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#else
+#define _POSIX_MAPPED_FILES 0
+#endif
+#if _POSIX_MAPPED_FILES > 0
+#include <sys/mman.h>
+#endif
 #include "TestMain.h"
 #include "vectorhash_core.h"
 
@@ -52,4 +61,89 @@ namespace {
 			CHECK( validate_result(i, pow2roundup(i)) );
 	}
 
+	// the SIMD versions of the finalization must give results identical to the scalar version
+	TEST(TestFinalize)
+	{
+		static const size_t widths[] = { 32, 64, 96, 128, 160, 256, 384, 512, 768, 1024 };
+		static const size_t lens[] = { 0, 1, 1000, 0x80000001 };
+		alignas(64) uint32_t h[4][vh_max_nint], z[4][vh_max_nint];
+		uint32_t ref[1024/32], res[1024/32];
+		uint32_t x = 0x6ec74615;
+		for( auto hw : widths )
+			for( auto len : lens )
+			{
+				for( size_t i=0; i < 4; ++i )
+					for( size_t j=0; j < vh_max_nint; ++j )
+					{
+						x = x*1664525 + 1013904223;
+						h[i][j] = x;
+					}
+				memcpy( z, h, sizeof(h) );
+				VectorHashFinalize(len, z[0], z[1], z[2], z[3], ref, IS_SCALAR, hw);
+				for( is_type simd = IS_SSE2; simd <= SIMDversion; simd = is_type(simd+1) )
+				{
+					memcpy( z, h, sizeof(h) );
+					VectorHashFinalize(len, z[0], z[1], z[2], z[3], res, simd, hw);
+					CHECK( memcmp(res, ref, hw/8) == 0 );
+				}
+			}
+	}
+
+#if _POSIX_MAPPED_FILES > 0
+	// short messages are padded using masked loads, check all lengths up to one block for each
+	// SIMD version, with the message ending right in front of a page that cannot be read
+	TEST(TestShortMessages)
+	{
+		static const size_t widths[] = { 32, 96, 256, 512, 1024 };
+		size_t pagesize = size_t(sysconf(_SC_PAGESIZE));
+		void* p = mmap(NULL, 2*pagesize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+		CHECK( p != MAP_FAILED );
+		if( p == MAP_FAILED )
+			return;
+		uint8_t* page = (uint8_t*)p;
+		for( size_t i=0; i < pagesize; ++i )
+			page[i] = uint8_t(fmix32(uint32_t(i)));
+		CHECK( mprotect(page+pagesize, pagesize, PROT_NONE) == 0 );
+		uint32_t ref[1024/32], res[1024/32];
+		for( auto hw : widths )
+			for( size_t len=0; len <= blocksize_for_width(hw); ++len )
+			{
+				const uint8_t* msg = page + pagesize - len;
+				VectorHash(msg, len, 0xfd4c799d, ref, IS_SCALAR, hw);
+				for( is_type simd = IS_SSE2; simd <= SIMDversion; simd = is_type(simd+1) )
+				{
+					VectorHash(msg, len, 0xfd4c799d, res, simd, hw);
+					CHECK( memcmp(res, ref, hw/8) == 0 );
+				}
+			}
+		munmap(p, 2*pagesize);
+	}
+#endif
+
+	// the routine returned by VectorHashGetImpl must give the same result as VectorHash itself
+	TEST(TestGetImpl)
+	{
+		uint8_t buf[3000];
+		for( size_t i=0; i < sizeof(buf); ++i )
+			buf[i] = uint8_t(fmix32(uint32_t(i)));
+		static const size_t lens[] = { 0, 7, 64, 1000, sizeof(buf) };
+		uint32_t ref[1024/32], res[1024/32];
+		for( size_t hw=32; hw <= 1024; hw += 32 )
+		{
+			vh_impl impl = VectorHashGetImpl(hw);
+			CHECK( impl != NULL );
+			if( impl == NULL )
+				continue;
+			for( auto len : lens )
+			{
+				VectorHash(buf, len, 0xfd4c799d, ref, hw);
+				impl(buf, len, 0xfd4c799d, res, hw);
+				CHECK( memcmp(res, ref, hw/8) == 0 );
+			}
+		}
+		CHECK( VectorHashGetImpl(0) == NULL );
+		CHECK( VectorHashGetImpl(33) == NULL );
+		CHECK( VectorHashGetImpl(2048) == NULL );
+	}
+
 }
@@ -18,9 +18,10 @@ uint32_t cksum[1024/32];
 
 int main ()
 {
-	void *buffer_raw = malloc((1<<20) + 63);
+	void *buffer_raw = malloc((1<<20) + 127);
 
 	// make sure bufffer is aligned on a 64-byte boundary
+	// the extra 64 bytes allow tests with misaligned buffers
 	uintptr ibuf = reinterpret_cast<uintptr>(buffer_raw);
 	uintptr mask = 0x3f;
 	ibuf = (ibuf+63)&(~mask);
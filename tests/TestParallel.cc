@@ -0,0 +1,110 @@
+//-------------------------------------------------------------------------------
+//  VectorHash - a very fast hash function optimized using SIMD instructions
+//
+//  Copyright (c) 2018-2025 Peter A.M. van Hoof
+//  All Rights Reserved
+//
+//  Distributed under the "zlib license". See the accompanying LICENSE file.
+//-------------------------------------------------------------------------------
+
+#include "TestMain.h"
+#include "vectorhash_core.h"
+
+namespace {
+
+	bool CheckParallel(const void* buf, size_t len, uint32_t seed, is_type simd, size_t hw, size_t nthreads)
+	{
+		uint32_t ref[1024/32], res[1024/32];
+		VectorHash(buf, len, seed, ref, IS_SCALAR, hw);
+		VectorHashParallel(buf, len, seed, res, simd, hw, nthreads);
+		for( size_t i=0; i < hw/32; ++i )
+			if( res[i] != ref[i] )
+				return false;
+		return true;
+	}
+
+	TEST(TestParallelFile)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		VectorHashParallel(buffer, 1048576, 0xfd4c799d, cksum, 128, 4);
+		CHECK( CheckHash(cksum, "5c3c9fb8481be32ea676886ab251f4fc") );
+		VectorHashParallel(buffer, 1048576, 0xfd4c799d, cksum, 1024, 0);
+		CHECK( CheckHash(cksum, "3dfe155d7c8fab0ccf04baf748bf2bd9a0dd00924eb7d3ba94af78ba1976232f"
+		                        "a4ec9c46080893e4321601b07f0e7aeac6a4ab010e505d443889fc978b23b0f9"
+		                        "44ca22d4e4f6079b94b8985dd1adc1b13f4d2a2c08dd53e22f3bb84eb0fbab75"
+		                        "06eff60a3089394a57f98b532a89cd66c7d6d2da971025c0cad83c09a3aa3d21") );
+	}
+
+	TEST(TestParallelThreads)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		static const size_t widths[] = { 32, 96, 128, 256, 512, 1024 };
+		static const size_t threads[] = { 1, 2, 3, 4, 7, 16, 64 };
+		for( is_type simd = IS_SCALAR; simd <= SIMDversion; simd = is_type(simd+1) )
+			for( auto hw : widths )
+				for( auto nt : threads )
+				{
+					CHECK( CheckParallel(buffer, 1048576, 0xfd4c799d, simd, hw, nt) );
+					CHECK( CheckParallel((const uint8_t*)buffer+3, 1048576-77, 0x6ec74615, simd, hw, nt) );
+				}
+	}
+
+	TEST(TestPrefetch)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		static const size_t widths[] = { 32, 128, 256, 1024 };
+		// the distance need not be a multiple of the block size, and may exceed the buffer size
+		static const size_t dists[] = { 0, 100, 256, 4096, 2000000 };
+		size_t dist0 = VectorHashGetPrefetch();
+		uint32_t ref[1024/32], res[1024/32];
+		for( auto hw : widths )
+		{
+			VectorHashSetPrefetch(0);
+			VectorHash(buffer, 1048576, 0xfd4c799d, ref, IS_SCALAR, hw);
+			for( auto d : dists )
+			{
+				VectorHashSetPrefetch(d);
+				CHECK_EQUAL( VectorHashGetPrefetch(), d );
+				for( is_type simd = IS_SCALAR; simd <= SIMDversion; simd = is_type(simd+1) )
+				{
+					VectorHash(buffer, 1048576, 0xfd4c799d, res, simd, hw);
+					CHECK( memcmp(res, ref, hw/8) == 0 );
+					VectorHashParallel(buffer, 1048576, 0xfd4c799d, res, simd, hw, 3);
+					CHECK( memcmp(res, ref, hw/8) == 0 );
+					vh_state st;
+					VectorHashInit(&st, 0xfd4c799d, simd, hw);
+					VectorHashUpdate(&st, buffer, 1048576);
+					VectorHashFinal(&st, res);
+					CHECK( memcmp(res, ref, hw/8) == 0 );
+				}
+			}
+		}
+		VectorHashSetPrefetch(dist0);
+	}
+
+	TEST(TestParallelUpdate)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		static const size_t widths[] = { 32, 128, 1024 };
+		static const size_t pieces[] = { 1, 1000, 1048576/3 };
+		uint32_t ref[1024/32], res[1024/32];
+		const uint8_t* buf = (const uint8_t*)buffer;
+		for( auto hw : widths )
+			for( auto np : pieces )
+			{
+				VectorHash(buf, 1048576, 0x6ec74615, ref, IS_SCALAR, hw);
+				vh_state st;
+				VectorHashInit(&st, 0x6ec74615, SIMDversion, hw);
+				// feed an initial piece so that the parallel part starts with a partial block
+				VectorHashUpdate(&st, buf, np, 4);
+				VectorHashUpdate(&st, buf+np, 1048576-np, 4);
+				VectorHashFinal(&st, res);
+				bool lgOK = true;
+				for( size_t i=0; i < hw/32; ++i )
+					if( res[i] != ref[i] )
+						lgOK = false;
+				CHECK( lgOK );
+			}
+	}
+
+}
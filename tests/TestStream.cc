@@ -0,0 +1,263 @@
+//-------------------------------------------------------------------------------
+//  VectorHash - a very fast hash function optimized using SIMD instructions
+//
+//  Copyright (c) 2018-2025 Peter A.M. van Hoof
+//  All Rights Reserved
+//
+//  Distributed under the "zlib license". See the accompanying LICENSE file.
+//-------------------------------------------------------------------------------
+
+#include <vector>
+#ifndef _MSC_VER
+#include <sys/uio.h>
+#endif
+#include "TestMain.h"
+#include "vectorhash_core.h"
+
+namespace {
+
+	// hash buffer in pieces of size piece, and compare to the result of a single call
+	bool CheckPieces(const uint8_t* buf, size_t len, size_t piece, is_type simd, size_t hw)
+	{
+		uint32_t ref[1024/32], res[1024/32];
+		VectorHash(buf, len, 0xfd4c799d, ref, IS_SCALAR, hw);
+
+		vh_state st;
+		VectorHashInit(&st, 0xfd4c799d, simd, hw);
+		for( size_t i=0; i < len; i += piece )
+			VectorHashUpdate(&st, buf+i, min(piece, len-i));
+		VectorHashFinal(&st, res);
+
+		for( size_t i=0; i < hw/32; ++i )
+			if( res[i] != ref[i] )
+				return false;
+		return true;
+	}
+
+	TEST(TestStreamEmpty)
+	{
+		vh_state st;
+		VectorHashInit(&st, 0xfd4c799d, 128);
+		VectorHashFinal(&st, cksum);
+		CHECK( CheckHash(cksum, "fe82e7d9998e9819c7ac954ea0a0ea8e") );
+		VectorHashUpdate(&st, buffer, 0);
+		VectorHashFinal(&st, cksum);
+		CHECK( CheckHash(cksum, "fe82e7d9998e9819c7ac954ea0a0ea8e") );
+	}
+
+	TEST(TestStreamFile)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		vh_state st;
+		VectorHashInit(&st, 0xfd4c799d, 128);
+		const uint8_t* p = (const uint8_t*)buffer;
+		VectorHashUpdate(&st, p, 1000);
+		VectorHashUpdate(&st, p+1000, 1048576-1000);
+		VectorHashFinal(&st, cksum);
+		CHECK( CheckHash(cksum, "5c3c9fb8481be32ea676886ab251f4fc") );
+	}
+
+	TEST(TestStreamPieces)
+	{
+		CHECK( ReadBuffer("test3072", 3072, buffer) );
+		const uint8_t* p = (const uint8_t*)buffer;
+		static const size_t pieces[] = { 1, 3, 64, 100, 256, 1000, 1024, 3072 };
+		static const size_t widths[] = { 32, 64, 96, 128, 160, 256, 512, 1024 };
+		for( is_type simd = IS_SCALAR; simd <= SIMDversion; simd = is_type(simd+1) )
+			for( auto hw : widths )
+				for( auto piece : pieces )
+				{
+					CHECK( CheckPieces(p, 3072, piece, simd, hw) );
+					CHECK( CheckPieces(p, 2999, piece, simd, hw) );
+					CHECK( CheckPieces(p+1, 2999, piece, simd, hw) );
+				}
+	}
+
+	TEST(TestStreamFinalRepeat)
+	{
+		// VectorHashFinal does not alter the state, so hashing may continue afterwards
+		CHECK( ReadBuffer("test3072", 3072, buffer) );
+		const uint8_t* p = (const uint8_t*)buffer;
+		uint32_t ref[1024/32];
+		VectorHash(p, 2000, 0xfd4c799d, ref, 256);
+		vh_state st;
+		VectorHashInit(&st, 0xfd4c799d, 256);
+		VectorHashUpdate(&st, p, 1500);
+		VectorHashFinal(&st, cksum);
+		VectorHashUpdate(&st, p+1500, 500);
+		VectorHashFinal(&st, cksum);
+		for( size_t i=0; i < 256/32; ++i )
+			CHECK( cksum[i] == ref[i] );
+	}
+
+#ifndef _MSC_VER
+	// split the buffer into segments of irregular lengths, including empty ones, and compare
+	// VectorHashV to the result of a single call
+	TEST(TestHashV)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		uint8_t* p = (uint8_t*)buffer;
+		static const size_t seglen[] = { 0, 1, 7, 100, 255, 256, 300, 1024, 1500, 4096, 70000 };
+		static const size_t widths[] = { 32, 96, 128, 256, 512, 1024 };
+		uint32_t ref[1024/32], res[1024/32];
+		for( is_type simd = IS_SCALAR; simd <= SIMDversion; simd = is_type(simd+1) )
+			for( auto hw : widths )
+				for( size_t k=0; k < sizeof(seglen)/sizeof(seglen[0]); ++k )
+				{
+					vector<struct iovec> iov;
+					size_t len = 0;
+					for( size_t i=0; len < 200000; ++i )
+					{
+						size_t n = seglen[(i*k+i/3) % (sizeof(seglen)/sizeof(seglen[0]))];
+						struct iovec v = { p+len, n };
+						iov.push_back(v);
+						len += n;
+					}
+					VectorHash(p, len, 0x6ec74615, ref, IS_SCALAR, hw);
+					VectorHashV(iov.data(), int(iov.size()), 0x6ec74615, res, simd, hw);
+					CHECK( memcmp(res, ref, hw/8) == 0 );
+				}
+		// a single segment and no segments at all
+		struct iovec v = { p, 5000 };
+		VectorHash(p, 5000, 0xfd4c799d, ref, 256);
+		VectorHashV(&v, 1, 0xfd4c799d, res, 256);
+		CHECK( memcmp(res, ref, 256/8) == 0 );
+		VectorHash(p, 0, 0xfd4c799d, ref, 256);
+		VectorHashV(NULL, 0, 0xfd4c799d, res, 256);
+		CHECK( memcmp(res, ref, 256/8) == 0 );
+	}
+#endif
+
+	TEST(TestMulti)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		static const size_t widths[] = { 128, 32, 1024, 96, 256, 512 };
+		static const size_t nw = sizeof(widths)/sizeof(widths[0]);
+		static const size_t lens[] = { 0, 1, 255, 256, 4097, 200000 };
+		uint32_t ref[1024/32], res[(128+32+1024+96+256+512)/32];
+		for( is_type simd = IS_SCALAR; simd <= SIMDversion; simd = is_type(simd+1) )
+			for( auto len : lens )
+			{
+				VectorHashMulti(buffer, len, 0x6ec74615, res, simd, widths, nw);
+				const uint32_t* p = res;
+				for( auto hw : widths )
+				{
+					VectorHash(buffer, len, 0x6ec74615, ref, IS_SCALAR, hw);
+					CHECK( memcmp(p, ref, hw/8) == 0 );
+					p += hw/32;
+				}
+			}
+		// states of different widths that are updated in uneven pieces
+		vh_state st[nw];
+		vh_state* pst[nw];
+		for( size_t i=0; i < nw; ++i )
+		{
+			VectorHashInit(&st[i], 0xfd4c799d, widths[i]);
+			pst[i] = &st[i];
+		}
+		const uint8_t* p = (const uint8_t*)buffer;
+		VectorHashUpdateMulti(pst, nw, p, 1000);
+		VectorHashUpdateMulti(pst, nw, p+1000, 150000);
+		VectorHashUpdateMulti(pst, nw, p+151000, 0);
+		VectorHashUpdateMulti(pst, nw, p+151000, 33);
+		for( size_t i=0; i < nw; ++i )
+		{
+			VectorHash(buffer, 151033, 0xfd4c799d, ref, widths[i]);
+			VectorHashFinal(&st[i], res);
+			CHECK( memcmp(res, ref, widths[i]/8) == 0 );
+		}
+	}
+
+	TEST(TestMultiSeed)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		static const uint32_t seeds[] = { 0xfd4c799d, 0, 0x6ec74615, 1, 2, 3, 0xffffffff, 4, 5, 6, 7, 8, 9, 10,
+										   11, 12, 13, 14, 15, 16 };
+		static const size_t ns[] = { 1, 2, 3, 5, 8, 20 };
+		static const size_t widths[] = { 32, 96, 128, 256, 512, 1024 };
+		static const size_t lens[] = { 0, 100, 1024, 4097, 200000 };
+		vector<uint32_t> res(20*1024/32);
+		uint32_t ref[1024/32];
+		for( is_type simd = IS_SCALAR; simd <= SIMDversion; simd = is_type(simd+1) )
+			for( auto hw : widths )
+				for( auto n : ns )
+					for( auto len : lens )
+					{
+						VectorHashMultiSeed((const uint8_t*)buffer+1, len, seeds, n, res.data(), simd, hw);
+						for( size_t k=0; k < n; ++k )
+						{
+							VectorHash((const uint8_t*)buffer+1, len, seeds[k], ref, IS_SCALAR, hw);
+							CHECK( memcmp(&res[k*hw/32], ref, hw/8) == 0 );
+						}
+					}
+		// states with the same width that are updated together in uneven pieces
+		vh_state st[3];
+		vh_state* pst[3] = { &st[0], &st[1], &st[2] };
+		for( size_t k=0; k < 3; ++k )
+			VectorHashInit(&st[k], seeds[k], 256);
+		const uint8_t* p = (const uint8_t*)buffer;
+		VectorHashUpdateMulti(pst, 3, p, 77);
+		VectorHashUpdateMulti(pst, 3, p+77, 300000);
+		VectorHashUpdateMulti(pst, 3, p+300077, 1000);
+		for( size_t k=0; k < 3; ++k )
+		{
+			VectorHash(buffer, 301077, seeds[k], ref, 256);
+			VectorHashFinal(&st[k], res.data());
+			CHECK( memcmp(res.data(), ref, 256/8) == 0 );
+		}
+	}
+
+	TEST(TestStateSave)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		const uint8_t* p = (const uint8_t*)buffer;
+		static const size_t widths[] = { 32, 96, 128, 256, 512, 1024 };
+		static const size_t splits[] = { 0, 1, 255, 256, 1023, 5000 };
+		uint8_t saved[VH_STATE_SAVE_MAX];
+		uint32_t ref[1024/32], res[1024/32];
+		for( is_type simd = IS_SCALAR; simd <= SIMDversion; simd = is_type(simd+1) )
+			for( auto hw : widths )
+				for( auto split : splits )
+				{
+					vh_state st;
+					VectorHashInit(&st, 0x6ec74615, simd, hw);
+					VectorHashUpdate(&st, p, split);
+					size_t n = VectorHashStateSave(&st, saved, sizeof(saved));
+					CHECK( n > 0 );
+					// the state is continued with whatever SIMD version the loading side has
+					vh_state st2;
+					memset(&st2, 0xff, sizeof(st2));
+					CHECK_EQUAL( VectorHashStateLoad(&st2, saved, n), 0 );
+					CHECK_EQUAL( st2.seed, uint32_t(0x6ec74615) );
+					VectorHashUpdate(&st2, p+split, 100000);
+					VectorHashFinal(&st2, res);
+					VectorHash(p, split+100000, 0x6ec74615, ref, IS_SCALAR, hw);
+					CHECK( memcmp(res, ref, hw/8) == 0 );
+				}
+
+		vh_state st;
+		VectorHashInit(&st, 0xfd4c799d, 1024);
+		VectorHashUpdate(&st, p, 1023);
+		size_t n = VectorHashStateSave(&st, saved, sizeof(saved));
+		CHECK( n <= sizeof(saved) );
+		CHECK_EQUAL( VectorHashStateSave(&st, saved, n-1), size_t(0) );
+		// the format is stable, so the saved state of a given calculation may never change
+		VectorHashInit(&st, 0xfd4c799d, 128);
+		VectorHashUpdate(&st, p, 1000);
+		n = VectorHashStateSave(&st, saved, sizeof(saved));
+		CHECK_EQUAL( n, size_t(28+4*16*4+232+4) );
+		VectorHash(saved, n, 0xfd4c799d, res, 128);
+		CHECK( CheckHash(res, "3c03abf2dd949667f2a37554133448c1") );
+		// damaged or truncated states are rejected
+		vh_state st2;
+		CHECK_EQUAL( VectorHashStateLoad(&st2, saved, n-1), -1 );
+		for( size_t i=0; i < n; i += 7 )
+		{
+			saved[i] ^= 0x20;
+			CHECK_EQUAL( VectorHashStateLoad(&st2, saved, n), -1 );
+			saved[i] ^= 0x20;
+		}
+		CHECK_EQUAL( VectorHashStateLoad(&st2, saved, n), 0 );
+	}
+
+}
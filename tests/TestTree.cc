@@ -0,0 +1,123 @@
+//-------------------------------------------------------------------------------
+//  VectorHash - a very fast hash function optimized using SIMD instructions
+//
+//  Copyright (c) 2018-2025 Peter A.M. van Hoof
+//  All Rights Reserved
+//
+//  Distributed under the "zlib license". See the accompanying LICENSE file.
+//-------------------------------------------------------------------------------
+
+#include <cstring>
+#include <vector>
+#include "TestMain.h"
+#include "vectorhash_core.h"
+
+namespace {
+
+	// calculate the tree checksum from the leaves, as a stream reader would do
+	void TreeFromLeaves(const void* buf, size_t len, uint32_t seed, void* out, is_type simd, size_t hw,
+						size_t chunksize)
+	{
+		size_t nleaves = VectorHashTreeLeaves(len, chunksize);
+		vector<uint32_t> leaves(nleaves*hw/32);
+		const uint8_t* p = (const uint8_t*)buf;
+		for( size_t i=0; i < nleaves; ++i )
+		{
+			size_t n = min(chunksize, len-i*chunksize);
+			VectorHash(p+i*chunksize, n, seed, &leaves[i*hw/32], simd, hw);
+		}
+		VectorHashTreeRoot(leaves.data(), nleaves, len, seed, out, simd, hw, chunksize);
+	}
+
+	TEST(TestTreeLeaves)
+	{
+		CHECK_EQUAL( VectorHashTreeLeaves(0, 0), size_t(1) );
+		CHECK_EQUAL( VectorHashTreeLeaves(1, 0), size_t(1) );
+		CHECK_EQUAL( VectorHashTreeLeaves(VH_TREE_CHUNKSIZE, 0), size_t(1) );
+		CHECK_EQUAL( VectorHashTreeLeaves(VH_TREE_CHUNKSIZE+1, 0), size_t(2) );
+		CHECK_EQUAL( VectorHashTreeLeaves(4096, 1024), size_t(4) );
+		CHECK_EQUAL( VectorHashTreeLeaves(4097, 1024), size_t(5) );
+	}
+
+	TEST(TestTreeFile)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		VectorHashTree(buffer, 1048576, 0xfd4c799d, cksum, 128, 0, 1);
+		uint32_t ref[1024/32];
+		VectorHash(buffer, 1048576, 0xfd4c799d, ref, 128);
+		// the tree checksum must differ from the normal checksum, even for a single chunk
+		CHECK( memcmp(cksum, ref, 128/8) != 0 );
+		VectorHashTree(buffer, 1048576, 0xfd4c799d, ref, 128, 0, 4);
+		CHECK( memcmp(cksum, ref, 128/8) == 0 );
+	}
+
+	TEST(TestTreeThreads)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		static const size_t widths[] = { 32, 96, 128, 256, 512, 1024 };
+		static const size_t chunks[] = { 1000, 4096, 65536 };
+		static const size_t threads[] = { 0, 1, 3, 8 };
+		uint32_t ref[1024/32], res[1024/32];
+		for( is_type simd = IS_SCALAR; simd <= SIMDversion; simd = is_type(simd+1) )
+			for( auto hw : widths )
+				for( auto cs : chunks )
+				{
+					size_t len = 1048576-77;
+					TreeFromLeaves((const uint8_t*)buffer+3, len, 0x6ec74615, ref, IS_SCALAR, hw, cs);
+					for( auto nt : threads )
+					{
+						VectorHashTree((const uint8_t*)buffer+3, len, 0x6ec74615, res, simd, hw, cs, nt);
+						CHECK( memcmp(res, ref, hw/8) == 0 );
+					}
+				}
+	}
+
+	TEST(TestTreeHashLeaves)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		// compute the leaves in two parts, as a windowed reader would do
+		size_t len = 1048576-77;
+		size_t nleaves = VectorHashTreeLeaves(len, 4096);
+		vector<uint32_t> leaves(nleaves*256/32);
+		VectorHashTreeHashLeaves(buffer, 65536, 0xfd4c799d, leaves.data(), 256, 4096, 3);
+		VectorHashTreeHashLeaves((const uint8_t*)buffer+65536, len-65536, 0xfd4c799d, &leaves[16*256/32],
+								 256, 4096, 0);
+		uint32_t ref[1024/32], res[1024/32];
+		VectorHashTreeRoot(leaves.data(), nleaves, len, 0xfd4c799d, res, 256, 4096);
+		VectorHashTree(buffer, len, 0xfd4c799d, ref, 256, 4096, 1);
+		CHECK( memcmp(res, ref, 256/8) == 0 );
+	}
+
+	TEST(TestTreeSensitivity)
+	{
+		CHECK( ReadBuffer("test9999", 1048576, buffer) );
+		uint32_t ref[1024/32], res[1024/32];
+		VectorHashTree(buffer, 65536, 0xfd4c799d, ref, 256, 4096, 1);
+		// the chunk size is part of the checksum
+		VectorHashTree(buffer, 65536, 0xfd4c799d, res, 256, 8192, 1);
+		CHECK( memcmp(res, ref, 256/8) != 0 );
+		// as is the seed
+		VectorHashTree(buffer, 65536, 0x6ec74615, res, 256, 4096, 1);
+		CHECK( memcmp(res, ref, 256/8) != 0 );
+		// swapping two chunks must change the checksum
+		vector<uint8_t> buf2((uint8_t*)buffer, (uint8_t*)buffer+65536);
+		for( size_t i=0; i < 4096; ++i )
+			swap( buf2[i], buf2[4096+i] );
+		VectorHashTree(buf2.data(), 65536, 0xfd4c799d, res, 256, 4096, 1);
+		CHECK( memcmp(res, ref, 256/8) != 0 );
+		// and so must a single bit flip
+		buf2.assign((uint8_t*)buffer, (uint8_t*)buffer+65536);
+		buf2[40000] ^= 0x10;
+		VectorHashTree(buf2.data(), 65536, 0xfd4c799d, res, 256, 4096, 1);
+		CHECK( memcmp(res, ref, 256/8) != 0 );
+		// an empty buffer has a single empty leaf
+		VectorHashTree(buffer, 0, 0xfd4c799d, res, 256, 4096, 1);
+		TreeFromLeaves(buffer, 0, 0xfd4c799d, ref, IS_SCALAR, 256, 4096);
+		CHECK( memcmp(res, ref, 256/8) == 0 );
+		// without leaves there is no tree, and nothing is stored
+		res[0] = 0x6ec74615;
+		VectorHashTreeRoot(NULL, 0, 0, 0xfd4c799d, res, 256, 4096);
+		CHECK_EQUAL( res[0], 0x6ec74615u );
+	}
+
+}
@@ -0,0 +1,28 @@
+#!/bin/bash
+
+# Throughput of vh128sum on a file that is not in the page cache, with and
+# without readahead hints. The optional argument sets the file size in MiB.
+# This is run as part of "make bench".
+
+size=${1:-512}
+bigfile='vhbench.cold.R6sq9'
+
+head -c ${size}M /dev/urandom > $bigfile
+sync
+
+bench_cold () {
+	# drop the file from the page cache, this does not require root privileges
+	dd if=/dev/null of=$bigfile oflag=nocache conv=notrunc,fdatasync count=0 2> /dev/null
+	local start=`date +%s.%N`
+	../bin/vh128sum $1 $bigfile > /dev/null
+	local stop=`date +%s.%N`
+	echo "$start $stop" | awk -v sz=$size -v opt="$1" '{printf "%-36s %10.1f MiB/s\n", opt, sz/($2-$1)}'
+}
+
+echo "coldcache: throughput reading a ${size} MiB file that is not cached"
+for opt in "--window 0 --readahead 0" "--window 0" "--readahead 0" "--readahead 4M" "" "--readahead 64M"; do
+	bench_cold "$opt"
+done
+echo
+
+rm -f $bigfile
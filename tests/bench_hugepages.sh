@@ -0,0 +1,46 @@
+#!/bin/bash
+
+# Throughput of vh512sum with and without huge pages for the I/O buffers, when
+# reading from a pipe and from a cached file with --direct. When perf is
+# available the number of dTLB misses is reported as well. The optional
+# argument sets the amount of data in MiB. This is run as part of "make bench".
+
+size=${1:-1024}
+bigfile='vhbench.huge.R6sq9'
+
+head -c ${size}M /dev/urandom > $bigfile
+
+if perf stat -e dTLB-load-misses true > /dev/null 2>&1; then
+	lgPerf=1
+fi
+
+bench_huge () {
+	local misses="n/a"
+	local start=`date +%s.%N`
+	if [ -n "$lgPerf" ]; then
+		misses=`eval "$1" 2>&1 > /dev/null | awk '/dTLB-load-misses/ {gsub(",", "", $1); print $1}'`
+	else
+		eval "$1" > /dev/null
+	fi
+	local stop=`date +%s.%N`
+	echo "$start $stop $misses" | awk -v sz=$size -v opt="$2" '{printf "%-36s %10.1f MiB/s %14s\n", opt, sz/($2-$1), $3}'
+}
+
+perfcmd=""
+if [ -n "$lgPerf" ]; then
+	perfcmd="perf stat -e dTLB-load-misses"
+fi
+
+echo "hugepages: throughput and dTLB misses reading ${size} MiB"
+printf "%-36s %15s %14s\n" "options" "throughput" "dTLB misses"
+for bs in 4M 16M; do
+	for opt in "" "--no-hugepages"; do
+		bench_huge "cat $bigfile | $perfcmd ../bin/vh512sum --bufsize $bs $opt" "stdin --bufsize $bs $opt"
+	done
+	for opt in "" "--no-hugepages"; do
+		bench_huge "$perfcmd ../bin/vh512sum --direct --bufsize $bs $opt $bigfile" "--direct --bufsize $bs $opt"
+	done
+done
+echo
+
+rm -f $bigfile
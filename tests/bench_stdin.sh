@@ -0,0 +1,21 @@
+#!/bin/bash
+
+# Throughput of vh256sum when reading from a pipe, for various buffer sizes.
+# The optional argument sets the amount of data in MiB. This is run as part of
+# "make bench".
+
+size=${1:-1024}
+
+bench_pipe () {
+	local start=`date +%s.%N`
+	head -c ${size}M /dev/zero | ../bin/vh256sum $1 > /dev/null
+	local stop=`date +%s.%N`
+	echo "$2 $start $stop" | awk -v sz=$size '{printf "%10s %10.1f MiB/s\n", $1, sz/($3-$2)}'
+}
+
+echo "stdin: throughput reading ${size} MiB from a pipe"
+printf "%10s %15s\n" "bufsize" "throughput"
+for bs in 4K 64K 256K 1M 4M 16M; do
+	bench_pipe "--bufsize $bs" $bs
+done
+echo
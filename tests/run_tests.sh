@@ -31,6 +31,27 @@ test_cks_stdin () {
 	fi
 }
 
+test_same_output () {
+	rm -f $tempnam ${tempnam}2
+	eval "arr=($1)"
+	"${arr[@]}" > $tempnam 2>&1
+	local retval1=$?
+	eval "arr=($2)"
+	"${arr[@]}" > ${tempnam}2 2>&1
+	local retval2=$?
+	if [ $retval1 -ne $retval2 ]; then
+	   echo "commands ==$1== and ==$2== return different status"
+	   exit 1;
+	fi
+	diff -q $tempnam ${tempnam}2
+	local retval3=$?
+	if [ $retval3 -ne 0 ]; then
+	   echo "commands ==$1== and ==$2== produce different output"
+	   exit 1;
+	fi
+	rm -f $tempnam ${tempnam}2
+}
+
 check_cmd () {
 	$1 > /dev/null
 	local retval1=$?
@@ -103,6 +124,31 @@ test_cks_file "../bin/vh128sum --tag --scalar -l256 test*" "BSD_output_256.txt"
 test_cks_file "../bin/vh512sum --scalar --tag -- test*" "BSD_output_512.txt"
 test_cks_file "../bin/vh512sum -l 1024 --scalar --tag test*" "BSD_output_1024.txt"
 
+test_cks_file "../bin/vh256sum -l 32 -b --threads 4 test*" "output_32.txt"
+test_cks_file "../bin/vh128sum --bin --threads 0 test*" "output_128.txt"
+test_cks_file "../bin/vh512sum -b --thr 3 test*" "output_512.txt"
+test_cks_file "../bin/vh512sum -l 1024 -b --threads 4 test*" "output_1024.txt"
+test_cks_file "../bin/vh512sum -l 1024 -b --threads 8 --sse2 test*" "output_1024.txt"
+
+test_cks_file "../bin/vh256sum -l 32 -b -j 4 test*" "output_32.txt"
+test_cks_file "../bin/vh128sum -bj0 test*" "output_128.txt"
+test_cks_file "../bin/vh512sum --jobs 3 --tag test*" "BSD_output_512.txt"
+test_cks_file "../bin/vh512sum -l 1024 -b --jobs 8 --threads 2 test*" "output_1024.txt"
+test_cks_file "../bin/vh128sum --tag -z -j 2 test*" "BSD_output_zero_128.txt"
+
+test_cks_file "../bin/vh256sum -l 32 -b --io uring test*" "output_32.txt"
+test_cks_file "../bin/vh128sum -b --io=uring --bufsize 1000 --iodepth 3 test*" "output_128.txt"
+test_cks_file "../bin/vh512sum -l 1024 --tag --io uring --bufsize 64K test*" "BSD_output_1024.txt"
+test_cks_file "../bin/vh128sum -b --io uring --tree --bufsize 100000 test*" "output_tree_128.txt"
+
+test_cks_file "../bin/vh128sum -b --direct test*" "output_128.txt"
+test_cks_file "../bin/vh512sum -l 1024 --tag --direct --bufsize 5000 test*" "BSD_output_1024.txt"
+test_cks_file "../bin/vh128sum -b --direct --tree --bufsize 100000 test*" "output_tree_128.txt"
+
+test_cks_file "../bin/vh128sum --tree -b test*" "output_tree_128.txt"
+test_cks_file "../bin/vh128sum --tree --threads 4 --scalar -b test*" "output_tree_128.txt"
+test_cks_file "../bin/vh256sum -l 128 --tree --tag test*" "BSD_output_tree_128.txt"
+
 test_cks_file "../bin/vh128sum --zero --binary test*" "output_zero_128.txt"
 test_cks_file "../bin/vh128sum --tag -z test*" "BSD_output_zero_128.txt"
 
@@ -124,6 +170,12 @@ test_cks_stdin "../bin/vh512sum -b --scalar" "test2048" "output_512.txt"
 test_cks_stdin "../bin/vh512sum -l 1024 -b" "test0128" "output_1024.txt"
 test_cks_stdin "../bin/vh512sum -l 1024 -b -" "test3072" "output_1024.txt"
 test_cks_stdin "../bin/vh512sum -l 1024 -b --scalar" "test3072" "output_1024.txt"
+test_cks_stdin "../bin/vh256sum -l 32 -b --bufsize 100" "test3072" "output_32.txt"
+test_cks_stdin "../bin/vh128sum -b --bufsize 1K" "test9999" "output_128.txt"
+test_cks_stdin "../bin/vh512sum -l 1024 -b --bufsize 3000" "test9999" "output_1024.txt"
+test_cks_stdin "../bin/vh128sum --tree -b" "test9999" "output_tree_128.txt"
+test_cks_stdin "../bin/vh128sum --tree -b --bufsize 1000" "test9999" "output_tree_128.txt"
+test_cks_stdin "../bin/vh128sum --tree -b --scalar" "test3072" "output_tree_128.txt"
 
 check_cmd "../bin/vh256sum -l 32 -c output_32.txt"
 check_cmd "../bin/vh128sum -l64 -c output_64.txt"
@@ -138,6 +190,8 @@ check_cmd "../bin/vh128sum -cq BSD_output_128.txt"
 check_cmd "../bin/vh128sum -l256 -c --quiet BSD_output_256.txt"
 check_cmd "../bin/vh128sum --length 512 -Q --check BSD_output_512.txt"
 check_cmd "../bin/vh512sum -l 1024 --check --stat BSD_output_1024.txt"
+check_cmd "../bin/vh128sum --tree -c output_tree_128.txt"
+check_cmd "../bin/vh128sum --tree -c BSD_output_tree_128.txt"
 
 check_cmd "../bin/vh256sum -h"
 check_cmd "../bin/vh512sum --help"
@@ -152,6 +206,15 @@ check_error_msg "../bin/vh256sum -l64 tost0000 -- --arg '' test0000" ": --arg: N
 check_error_msg "../bin/vh256sum -l64 tost0000 -- --arg '' test0000" ": '': No such file or directory"
 check_error_msg "../bin/vh256sum -l64 tost0000 -b -- --arg '' test0000" "73711a77d6031b6f \*test0000"
 
+check_error_msg "../bin/vh128sum -l 64,33 test0000" "length must be a multiple of 32 between 32 and 1024"
+check_error_msg "../bin/vh128sum -l 64, test0000" "invalid length: '64,'"
+check_error_msg "../bin/vh128sum -c -l 64,128 output_128.txt" "only a single length can be used when verifying checksums"
+check_error_msg "../bin/vh128sum --tree -l 64,128 test0000" "only a single length can be used with --tree"
+
+check_error_msg "../bin/vh128sum --seed 1,-2 test0000" "invalid seed: '-2'"
+check_error_msg "../bin/vh128sum --seed 0x1g test0000" "invalid seed: '0x1g'"
+check_error_msg "../bin/vh128sum -c --seed 1,2 output_128.txt" "only a single seed can be used when verifying checksums"
+
 # test widths that are not a power of 2
 check_error_msg "../bin/vh256sum -l96 t0 test0000" "fdcdf538d6031b6f8a613d7f  test0000"
 check_error_msg "../bin/vh256sum -l160 t0 test0000" "a49af44fdf9952d380d2cb84aace19bf6c0f58c8  test0000"
@@ -167,6 +230,23 @@ check_error_msg "../bin/vh256sum -l64 --len sum" "invalid length: 'sum'"
 check_error_msg "../bin/vh256sum -l64 --length 156" "invalid length: '156'"
 check_error_msg "../bin/vh256sum -l64 --length 156" "length must be a multiple of 32 between 32 and 1024"
 check_error_msg "../bin/vh256sum -l64 tost0000" "tost0000: No such file or directory"
+check_error_msg "../bin/vh256sum --threads x test0128" "invalid number of threads: 'x'"
+check_error_msg "../bin/vh256sum -j x test0128" "invalid number of jobs: 'x'"
+check_error_msg "../bin/vh256sum --bufsize 0 test0128" "invalid buffer size: '0'"
+check_error_msg "../bin/vh256sum --bufsize 1X test0128" "invalid buffer size: '1X'"
+check_error_msg "../bin/vh256sum --window 1MB test0128" "invalid window size: '1MB'"
+check_error_msg "../bin/vh256sum --readahead -1 test0128" "invalid readahead size: '-1'"
+check_error_msg "../bin/vh256sum test0128 --bufsize" "option '--bufsize' requires an argument"
+check_error_msg "../bin/vh256sum test0128 --win" "option '--win' requires an argument"
+check_error_msg "../bin/vh256sum test0128 --threads" "option '--threads' requires an argument"
+check_error_msg "../bin/vh256sum test0128 -bj" "option requires an argument -- 'j'"
+check_error_msg "../bin/vh256sum test0128 -l" "option requires an argument -- 'l'"
+check_error_msg "../bin/vh256sum test0128 --seed" "option '--seed' requires an argument"
+check_error_msg "../bin/vh256sum --io aio test0128" "invalid I/O method: 'aio'"
+check_error_msg "../bin/vh256sum --iodepth 0 test0128" "invalid I/O queue depth: '0'"
+check_error_msg "../bin/vh256sum -j 4 test0128 tost0000" "tost0000: No such file or directory"
+check_error_msg "../bin/vh128sum -c BSD_output_tree_128.txt" "no properly formatted VH128 checksum lines found"
+check_error_msg "../bin/vh128sum --tree -c BSD_output_128.txt" "no properly formatted VHT128 checksum lines found"
 
 check_error_msg "../bin/vh256sum -l64 -i test0128" "the --ignore-missing option is meaningful only when verifying checksums"
 check_error_msg "../bin/vh256sum -l64 -Q test0128" "the --status option is meaningful only when verifying checksums"
@@ -218,13 +298,137 @@ check_error_msg "../bin/vh128sum -wcl256 error2_256.txt" "error2_256.txt: 12: im
 check_error_msg "../bin/vh128sum -wcl256 error2_256.txt" "error2_256.txt: 13: improperly formatted VH256 checksum line"
 check_error_msg "../bin/vh128sum -wcl512 BSD_error1_512.txt" "BSD_error1_512.txt: 7: improperly formatted VH512 checksum line"
 
+test_same_output "../bin/vh128sum test0128 tost0000 test9999 test0256" "../bin/vh128sum -j 4 test0128 tost0000 test9999 test0256"
+test_same_output "../bin/vh128sum -c output_128.txt" "../bin/vh128sum -c --threads 4 output_128.txt"
+test_same_output "../bin/vh128sum -wc error1_128.txt" "../bin/vh128sum -wc -j 3 error1_128.txt"
+test_same_output "../bin/vh128sum -wc error1_128.txt" "../bin/vh128sum -wc --threads 3 error1_128.txt"
+test_same_output "../bin/vh128sum -wcl256 error2_256.txt" "../bin/vh128sum -wcl256 --threads 0 error2_256.txt"
+test_same_output "../bin/vh128sum -wcl512 BSD_error1_512.txt" "../bin/vh128sum -wcl512 --threads 16 BSD_error1_512.txt"
+test_same_output "../bin/vh128sum -ci error1_128.txt" "../bin/vh128sum -ci --threads 2 error1_128.txt"
+
 check_no_error_msg "../bin/vh128sum --check --ignore-missing error1_128.txt" "tost3072: No such file or directory"
 check_no_error_msg "../bin/vh128sum -ci error1_128.txt" "tost3072: FAILED open or read"
 
 check_no_output "../bin/vh128sum -Qcl256 error2_256.txt"
+check_no_output "../bin/vh128sum -Qcl256 --threads 4 error2_256.txt"
 check_no_output "../bin/vh128sum -cl64 --status error3_64.txt"
 check_no_output "../bin/vh128sum -cq output_128.txt"
 
+# files larger than the window are read in several pieces
+bigfile='vhtest.big.R6sq9'
+cat test9999 test3072 test9999 test0768 test9999 > $bigfile
+test_same_output "../bin/vh128sum --window 0 $bigfile" "../bin/vh128sum --window 1 $bigfile"
+test_same_output "../bin/vh128sum --window 0 --readahead 0 $bigfile" "../bin/vh128sum --window 1 --readahead 1K $bigfile"
+test_same_output "../bin/vh128sum --readahead 0 test*" "../bin/vh128sum --readahead 64M test*"
+test_same_output "../bin/vh128sum $bigfile test0128 tost0000 $bigfile" "../bin/vh128sum --io uring $bigfile test0128 tost0000 $bigfile"
+test_same_output "../bin/vh128sum --tree $bigfile" "../bin/vh128sum --io uring --tree --iodepth 2 $bigfile"
+test_same_output "../bin/vh128sum -c error1_128.txt" "../bin/vh128sum --io uring --threads 3 -c error1_128.txt"
+test_same_output "../bin/vh128sum $bigfile test0128 tost0000" "../bin/vh128sum --direct $bigfile test0128 tost0000"
+test_same_output "../bin/vh128sum --tree $bigfile" "../bin/vh128sum --direct --io uring --tree $bigfile"
+test_same_output "../bin/vh128sum -c error1_128.txt" "../bin/vh128sum --direct -c error1_128.txt"
+test_same_output "../bin/vh512sum --direct --bufsize 4M $bigfile" "../bin/vh512sum --direct --bufsize 4M --no-hugepages $bigfile"
+test_same_output "../bin/vh512sum --io uring --bufsize 3M $bigfile" "../bin/vh512sum --io uring --bufsize 3M --no-hu $bigfile"
+test_same_output "../bin/vh128sum --window 0 $bigfile" "../bin/vh128sum --window 2M --threads 4 $bigfile"
+test_same_output "../bin/vh128sum --window 0 $bigfile" "../bin/vh128sum --window 1M --drop-cache $bigfile"
+test_same_output "../bin/vh512sum -l 1024 --window 0 $bigfile" "../bin/vh512sum -l 1024 --window 1M $bigfile"
+test_same_output "../bin/vh128sum --tree --window 0 $bigfile" "../bin/vh128sum --tree --window 1M $bigfile"
+test_same_output "../bin/vh128sum --tree --window 0 $bigfile" "../bin/vh128sum --tree --window 2M --threads 0 $bigfile"
+# pipes and files in /proc do not report their size, they must be read sequentially with every I/O method
+for opt in "" "--io uring" "--direct" "-j 2" "-l 128,256"; do
+	test_same_output "bash -c '../bin/vh128sum $opt <(cat test9999) test0128 | cut -c1-32'" \
+		"bash -c '../bin/vh128sum $opt test9999 test0128 | cut -c1-32'"
+done
+test_same_output "bash -c '../bin/vh128sum --io uring /proc/version | cut -c1-32'" \
+	"bash -c '../bin/vh128sum --io uring < /proc/version | cut -c1-32'"
+# small files are checksummed in batches, a large or missing file in between ends a batch
+test_same_output "../bin/vh256sum -l 96 test0000 test0128 $bigfile test1024 tost0000 test3072 test9999" \
+	"../bin/vh256sum -l 96 -j 2 test0000 test0128 $bigfile test1024 tost0000 test3072 test9999"
+test_same_output "../bin/vh512sum --bufsize 1K test*" "../bin/vh512sum -j 3 test*"
+# several widths in a single pass give the same results as separate runs, one line per width
+test_same_output "../bin/vh128sum -l 128,96,1024 --window 1M $bigfile" \
+	"sh -c '../bin/vh128sum $bigfile; ../bin/vh128sum -l 96 $bigfile; ../bin/vh128sum -l 1024 $bigfile'"
+test_same_output "../bin/vh128sum --tag -l 256,32 --direct $bigfile" \
+	"sh -c '../bin/vh128sum --tag -l 256 $bigfile; ../bin/vh128sum --tag -l 32 $bigfile'"
+test_same_output "sh -c '../bin/vh128sum -l 64,512 < $bigfile'" \
+	"sh -c '../bin/vh128sum -l 64 < $bigfile; ../bin/vh128sum -l 512 < $bigfile'"
+test_same_output "../bin/vh128sum -l 128,256 test0000 tost0000 test9999" \
+	"../bin/vh128sum -l 128,256 -j 2 test0000 tost0000 test9999"
+# several seeds in a single pass, one line per seed, also combined with several widths
+test_same_output "../bin/vh128sum --seed 1,0x2,3 $bigfile" \
+	"sh -c '../bin/vh128sum --seed 1 $bigfile; ../bin/vh128sum --seed 2 $bigfile; ../bin/vh128sum --seed 3 $bigfile'"
+test_same_output "../bin/vh128sum --seed 0xfd4c799d test0128 test9999" "../bin/vh128sum test0128 test9999"
+test_same_output "../bin/vh128sum --tag --seed 7,8 -l 32,256 test9999" \
+	"sh -c '../bin/vh128sum --tag --seed 7 -l 32 test9999; ../bin/vh128sum --tag --seed 8 -l 32 test9999; \
+	../bin/vh128sum --tag --seed 7 -l 256 test9999; ../bin/vh128sum --tag --seed 8 -l 256 test9999'"
+# an interrupted calculation is simulated by checkpointing a prefix of the input, resuming gives the full checksum;
+# a pipe has no size, so only the anchor is checked when the file is resumed
+ckfile='vhtest.ck.R6sq9'
+head -c 3000000 $bigfile > $bigfile.pre
+test_same_output "sh -c 'cat $bigfile.pre | ../bin/vh128sum --checkpoint $ckfile > /dev/null; \
+	../bin/vh128sum --checkpoint $ckfile --resume --window 1M $bigfile'" "../bin/vh128sum $bigfile"
+test_same_output "sh -c '../bin/vh512sum -l 96 --checkpoint $ckfile < $bigfile.pre > /dev/null; \
+	cat $bigfile | ../bin/vh512sum -l 96 --checkpoint $ckfile --resume'" "sh -c '../bin/vh512sum -l 96 < $bigfile'"
+# the final state is kept, so resuming a completed calculation reads nothing new
+test_same_output "../bin/vh512sum -l 96 --checkpoint $ckfile --resume $bigfile" "../bin/vh512sum -l 96 $bigfile"
+check_error_msg "../bin/vh512sum -l 96 --checkpoint $ckfile --resume $bigfile.pre" "input shorter than the checkpoint"
+check_error_msg "../bin/vh512sum --checkpoint $ckfile --resume $bigfile" "invalid checkpoint"
+check_error_msg "../bin/vh512sum -l 96 --seed 1 --checkpoint $ckfile --resume $bigfile" "invalid checkpoint"
+# a checkpoint is refused for input of a different size, or with different data at either end of the processed part
+check_error_msg "sh -c '../bin/vh128sum --checkpoint $ckfile $bigfile.pre > /dev/null; \
+	../bin/vh128sum --checkpoint $ckfile --resume $bigfile'" "the input does not match the checkpoint"
+cp $bigfile.pre $ckfile.in
+printf 'x' | dd of=$ckfile.in bs=1 seek=2999000 conv=notrunc 2> /dev/null
+check_error_msg "../bin/vh128sum --checkpoint $ckfile --resume $ckfile.in" "the input does not match the checkpoint"
+check_error_msg "sh -c 'cat $ckfile.in | ../bin/vh128sum --checkpoint $ckfile --resume'" \
+	"the input does not match the checkpoint"
+test_same_output "../bin/vh128sum --checkpoint $ckfile --resume $bigfile.pre" "../bin/vh128sum $bigfile.pre"
+check_error_msg "../bin/vh128sum --resume $bigfile" "the --resume option requires --checkpoint"
+check_error_msg "../bin/vh128sum --checkpoint $ckfile $bigfile test0000" "only a single FILE can be used with --checkpoint"
+# with --incremental only the appended part is read, a rewritten file is checksummed from the start
+logfile='vhtest.log.R6sq9'
+rm -f $logfile.vhstate
+cp $bigfile.pre $logfile
+test_same_output "../bin/vh256sum --incremental $logfile" "../bin/vh256sum $logfile"
+tail -c +3000001 $bigfile >> $logfile
+test_same_output "../bin/vh256sum --incremental --window 1M $logfile" "../bin/vh256sum $logfile"
+check_no_error_msg "../bin/vh256sum --incremental --verbose $logfile" "reading it from the start"
+printf 'x' | dd of=$logfile bs=1 seek=100 conv=notrunc 2> /dev/null
+test_same_output "../bin/vh256sum --incremental $logfile" "../bin/vh256sum $logfile"
+head -c 1000 $bigfile > $logfile
+test_same_output "../bin/vh256sum --incremental $logfile test0128" "../bin/vh256sum $logfile test0128"
+test_same_output "../bin/vh256sum --incremental -l 64 --tag $logfile" "../bin/vh256sum -l 64 --tag $logfile"
+check_error_msg "../bin/vh256sum --incremental -" "standard input cannot be checksummed with --incremental"
+check_error_msg "../bin/vh256sum --incremental /dev/null" "only regular files can be checksummed with --incremental"
+check_error_msg "../bin/vh256sum --incremental --tree $logfile" "the --incremental option cannot be combined"
+# the index holds the normal checksum, the chunk checksums do not depend on the window or number of threads
+rm -f $bigfile.vhidx $logfile.vhidx
+test_same_output "../bin/vh128sum --index 100K $bigfile" "../bin/vh128sum $bigfile"
+cp $bigfile.vhidx $logfile.vhidx
+test_same_output "../bin/vh128sum --index 100K --window 1M --threads 3 $bigfile" "../bin/vh128sum $bigfile"
+test_same_output "cat $bigfile.vhidx" "cat $logfile.vhidx"
+check_cmd "../bin/vh128sum --verify-range 0:3149568 $bigfile"
+check_cmd "../bin/vh128sum --verify-range 1M:1K --window 1M $bigfile"
+cp $bigfile $logfile
+printf 'x' | dd of=$logfile bs=1 seek=10 conv=notrunc 2> /dev/null
+printf 'x' | dd of=$logfile bs=1 seek=2000000 conv=notrunc 2> /dev/null
+printf 'x' | dd of=$logfile bs=1 seek=2100000 conv=notrunc 2> /dev/null
+check_error_msg "../bin/vh128sum --verify-range 1900000:300000 $logfile" "$logfile: 1945600:204800 FAILED"
+check_no_output "../bin/vh128sum --verify-range 1M:500K --quiet $logfile"
+check_no_output "../bin/vh128sum --diff-index $bigfile.vhidx $logfile.vhidx"
+check_cmd "../bin/vh128sum --index 100K $logfile"
+check_error_msg "../bin/vh128sum --diff-index $bigfile.vhidx $logfile.vhidx" "^0:102400$"
+check_error_msg "../bin/vh128sum --diff-index $bigfile.vhidx $logfile.vhidx" "^1945600:204800$"
+head -c 1000000 $bigfile > $logfile
+check_cmd "../bin/vh128sum --index 100K $logfile"
+check_error_msg "../bin/vh128sum --diff-index $logfile.vhidx $bigfile.vhidx" "^921600:2227968$"
+check_error_msg "../bin/vh128sum --verify-range 900K:200K $logfile" "the range exceeds the indexed length"
+check_error_msg "../bin/vh128sum --verify-range 100 $bigfile" "invalid range: '100'"
+check_error_msg "../bin/vh128sum --index 0 $bigfile" "invalid chunk size: '0'"
+check_error_msg "../bin/vh128sum --index 4K /dev/null" "only regular files can be checksummed with --index"
+check_error_msg "../bin/vh128sum $bigfile --index" "option '--index' requires an argument"
+check_error_msg "../bin/vh128sum --index 1M --tree $bigfile" "cannot be combined with each other"
+rm -f $bigfile $bigfile.pre $ckfile $ckfile.in $logfile $logfile.vhstate test0128.vhstate $bigfile.vhidx $logfile.vhidx
+
 echo "===================================="
 echo "$0: all tests succeeded"
 echo "===================================="